@@ -89,6 +89,25 @@
 ** 10/21/2013   D. McMahon      Allow status line text in morq_set_status()
 ** 04/27/2015   D. McMahon      Bump version
 ** 05/07/2015   D. McMahon      Make morq_get_range use 64-bit ints
+** 10/17/2026   D. McMahon      Add FUSED to OwaAlternate
+** 10/17/2026   D. McMahon      Add OwaStmtCache
+** 10/17/2026   D. McMahon      Add OwaSessionPool
+** 10/17/2026   D. McMahon      Add morq_writev and STREAM to OwaAlternate
+** 10/17/2026   D. McMahon      Use socket_writev for morq_writev
+** 10/17/2026   D. McMahon      Add morq_send_file, use it in handle_file
+** 10/17/2026   D. McMahon      Add describe cache limit to Describe
+** 10/17/2026   D. McMahon      Add DescribePreload
+** 10/17/2026   D. McMahon      Add DELTA to OwaAlternate
+** 10/17/2026   D. McMahon      Add mowa_reset_async stubs
+** 10/17/2026   D. McMahon      Add Queue
+** 10/17/2026   D. McMahon      Add ReadAhead
+** 10/17/2026   D. McMahon      Add PREFETCH to DocLobs
+** 10/17/2026   D. McMahon      Add WriteBehind
+** 10/17/2026   D. McMahon      Add Spill, release spilled POST bodies
+** 10/17/2026   D. McMahon      Check the morq_send_file result in handle_file
+** 10/17/2026   D. McMahon      Run the describe preload from the cleanup thread
+** 10/17/2026   D. McMahon      Add mowa_queue_wait and mowa_queue_wake stubs
+** 10/17/2026   D. McMahon      Add CACHE to DocLobs
 */
 
 #define APACHE_LINKAGE
@@ -585,9 +604,9 @@ static int handle_file(daemon_context *pdctx, request_rec *r, char *uri)
     os_objhand  fp;
     char        pmimetype[256];
     char        fpath[1024];
-    char        outbuf[HTBUF_BLOCK_SIZE];
+    char        buffer[HTBUF_BLOCK_SIZE];
     un_long     fage, clen, ctot;
-    un_long     nbytes;
+    long_64     sent;
     int         i;
 
     i = str_concat(fpath, 0, pdctx->froot, sizeof(fpath)-1);
@@ -614,14 +633,24 @@ static int handle_file(daemon_context *pdctx, request_rec *r, char *uri)
     */
     morq_send_header(r);
 
-    for (ctot = clen; ctot > 0; ctot -= nbytes)
+    /*
+    ** Copy the file through a buffer if sendfile can't be used on it;
+    ** if the transfer fails partway the connection has to be dropped,
+    ** since the client was promised clen bytes.
+    */
+    sent = morq_send_file(r, fpath, fp, (long_64)0, (long_64)clen);
+    if (sent == SEND_FILE_UNAVAILABLE)
     {
-        nbytes = sizeof(outbuf);
-        if (nbytes > ctot) nbytes = ctot;
-        i = file_read_data(fp, outbuf, (int)nbytes);
-        if (i != (int)nbytes) goto ff_err;
-        morq_write(r, outbuf, (int)nbytes);
+        file_seek(fp, 0L);
+        for (ctot = clen; ctot > 0; ctot -= (un_long)i)
+        {
+            i = (ctot > sizeof(buffer)) ? (int)sizeof(buffer) : (int)ctot;
+            if (file_read_data(fp, buffer, i) != i) break;
+            if (morq_write(r, buffer, (long)i) != (long)i) break;
+        }
+        if (ctot > 0) sent = SEND_FILE_FAILED;
     }
+    if (sent == SEND_FILE_FAILED) r->sock_end = -1;
 
 ff_err:
     file_close(fp);
@@ -741,7 +770,7 @@ void mowa_semaphore_create(owa_context *octx)
     /* Not needed because pool size == nthreads */
 }
 
-int mowa_semaphore_get(owa_context *octx)
+int mowa_semaphore_get(owa_context *octx, int wait_ms)
 {
     return(1); /* pool size == nthreads */
 }
@@ -751,6 +780,28 @@ void mowa_semaphore_put(owa_context *octx)
     /* Not needed because pool size == nthreads */
 }
 
+int mowa_queue_wait(owa_context *octx, int ticket, int wait_ms)
+{
+    /* Never waits long because pool size == nthreads */
+    os_milli_sleep(QUEUE_POLL_MS);
+    return(0);
+}
+
+void mowa_queue_wake(owa_context *octx, int ticket)
+{
+    /* Not needed because pool size == nthreads */
+}
+
+int mowa_reset_async(owa_context *octx)
+{
+    return(0); /* No cleanup thread, resets are always done in-line */
+}
+
+void mowa_thread_wake(owa_context *octx)
+{
+    /* Not needed because there's no cleanup thread */
+}
+
 void morq_create_mutex(request_rec *request, owa_context *octx)
 {
     /* Nothing to do - mutex created during startup */
@@ -1006,6 +1057,25 @@ long morq_write(request_rec *request, char *buffer, long buflen)
     return((long)socket_write(request->sock, buffer, buflen));
 }
 
+/*
+** Write an array of fixed-width slices, each with its own length,
+** using gathered writes straight from the caller's buffer.
+*/
+long morq_writev(request_rec *request, char *buffer, int stride,
+                 un_short *lens, int nvec)
+{
+    return((long)socket_writev(request->sock, buffer, stride, lens, nvec));
+}
+
+/*
+** Send part of an open file to the client with socket_sendfile
+*/
+long_64 morq_send_file(request_rec *request, char *fpath, os_objhand fp,
+                       long_64 off, long_64 len)
+{
+    return(socket_sendfile(request->sock, fp, off, len));
+}
+
 void morq_print_int(request_rec *request, char *fmt, long ival)
 {
     int   slen;
@@ -1240,6 +1310,7 @@ static void main_server(void *ctx)
                 {
                     result = owa_handle_request(rr.octx, &rr, rr.args,
                                                 rr.rtype, &owa_req);
+                    owa_free_args(&owa_req);
                 }
                 else
                     result = handle_file(pdctx, &rr, rr.uri);
@@ -1356,8 +1427,12 @@ static void mowa_diag(owa_context *octx, char *dstr)
     }
 }
 
-static void mowa_desc(owa_context *octx, char *dstr, char *schema)
+static void mowa_desc(owa_context *octx, char *dstr, char *schema,
+                      char *maxstr)
 {
+    int   n;
+    char *sptr;
+
     /*
     ** Parse and set the describe mode and schema
     */
@@ -1371,6 +1446,15 @@ static void mowa_desc(owa_context *octx, char *dstr, char *schema)
             octx->descmode = DESC_MODE_RELAXED;
     }
     if (schema) octx->desc_schema = schema;
+
+    /* Optional limit on the number of cached describe results */
+    if (maxstr)
+    {
+        n = 0;
+        for (sptr = maxstr; ((*sptr >= '0') && (*sptr <= '9')); ++sptr)
+            n = n * 10 + (*sptr - '0');
+        octx->desc_max = n;
+    }
 }
 
 static void mowa_alt(owa_context *octx, char *astr)
@@ -1404,6 +1488,12 @@ static void mowa_alt(owa_context *octx, char *astr)
             octx->altflags |= ALT_MODE_CGIPOST;
         else if (str_substr(astr, "IPADDR",  1))
             octx->altflags |= ALT_MODE_IPADDR;
+        else if (str_substr(astr, "FUSED",  1))
+            octx->altflags |= ALT_MODE_FUSED;
+        else if (str_substr(astr, "STREAM",  1))
+            octx->altflags |= ALT_MODE_STREAM;
+        else if (str_substr(astr, "DELTA",  1))
+            octx->altflags |= ALT_MODE_DELTA;
     }
 }
 
@@ -1553,6 +1643,35 @@ static void mowa_upmx(owa_context *octx, char *umaxstr)
     octx->upmax = (umaxstr) ? str_to_mem(umaxstr) : 0;
 }
 
+static void mowa_rdahd(owa_context *octx, char *sizestr)
+{
+    /*
+    ** Set the block size for pipelined LOB downloads
+    */
+    octx->readahead = (sizestr) ? str_to_mem(sizestr) : 0;
+    if (octx->readahead > HTBUF_READ_AHEAD)
+        octx->readahead = HTBUF_READ_AHEAD;
+}
+
+static void mowa_wrbhd(owa_context *octx, char *sizestr)
+{
+    /*
+    ** Set the slot size for pipelined LOB uploads
+    */
+    octx->writebehind = (sizestr) ? str_to_mem(sizestr) : 0;
+    if (octx->writebehind > HTBUF_WRITE_BEHIND)
+        octx->writebehind = HTBUF_WRITE_BEHIND;
+}
+
+static void mowa_spill(owa_context *octx, char *sizestr, char *dirstr)
+{
+    /*
+    ** Set the size above which POST bodies go to a temp file
+    */
+    octx->spillsize = (sizestr) ? str_to_mem(sizestr) : 0;
+    octx->spilldir = dirstr;
+}
+
 static void mowa_pool(owa_context *octx, char *poolstr, int nthreads)
 {
     /* Do nothing - poolsize is always == nthreads */
@@ -1579,6 +1698,62 @@ static const char *mowa_wait(owa_context *octx,
     return((char *)0);
 }
 
+static void mowa_queue(owa_context *octx, char *limitstr, char *retrystr)
+{
+    char *sptr;
+
+    octx->q_limit = 0;
+    for (sptr = limitstr; ((*sptr >= '0') && (*sptr <= '9')); ++sptr)
+        octx->q_limit = octx->q_limit * 10 + (*sptr - '0');
+
+    if (retrystr)
+    {
+        octx->q_retry = 0;
+        for (sptr = retrystr; ((*sptr >= '0') && (*sptr <= '9')); ++sptr)
+            octx->q_retry = octx->q_retry * 10 + (*sptr - '0');
+    }
+}
+
+static void mowa_stmtc(owa_context *octx, char *sizestr)
+{
+    int   nstmts = 0;
+    char *sptr;
+
+    for (sptr = sizestr; ((*sptr >= '0') && (*sptr <= '9')); ++sptr)
+        nstmts = nstmts * 10 + (*sptr - '0');
+    octx->stmt_cache = nstmts;
+}
+
+static void mowa_spool(owa_context *octx,
+                       char *minstr, char *maxstr, char *incrstr)
+{
+    int   n;
+    char *sptr;
+
+    n = 0;
+    for (sptr = minstr; ((*sptr >= '0') && (*sptr <= '9')); ++sptr)
+        n = n * 10 + (*sptr - '0');
+    octx->spool_min = n;
+
+    /* Zero means use the size of the connection pool */
+    n = 0;
+    if (maxstr)
+        for (sptr = maxstr; ((*sptr >= '0') && (*sptr <= '9')); ++sptr)
+            n = n * 10 + (*sptr - '0');
+    octx->spool_max = n;
+
+    /* A non-zero increment also marks session pool mode as enabled */
+    n = 1;
+    if (incrstr)
+    {
+        n = 0;
+        for (sptr = incrstr; ((*sptr >= '0') && (*sptr <= '9')); ++sptr)
+            n = n * 10 + (*sptr - '0');
+        if (n <= 0) n = 1;
+    }
+    octx->spool_incr = n;
+}
+
 static void mowa_uid(owa_context *octx, char *uid)
 {
     char *sptr;
@@ -1609,7 +1784,9 @@ static void mowa_uid(owa_context *octx, char *uid)
 
 static void mowa_lobs(owa_context *octx, char *ltypes)
 {
-    int lobtypes = 0;
+    int      lobtypes = 0;
+    long_64  size;
+    char    *sptr;
 
     if (ltypes)
     {
@@ -1623,6 +1800,25 @@ static void mowa_lobs(owa_context *octx, char *ltypes)
             octx->lontypes = LONG_MODE_RETURN_LEN;
         else if (str_substr(ltypes, "LONG_FETCH_LENGTH", 1))
             octx->lontypes = LONG_MODE_FETCH_LEN;
+
+        sptr = str_substr(ltypes, "PREFETCH", 1);
+        if (sptr)
+        {
+            sptr += str_length("PREFETCH");
+            if (*sptr == '=') ++sptr;
+            size = (*sptr) ? str_to_mem(sptr) : (long_64)HTBUF_BLOCK_SIZE;
+            if (size > (long_64)HTBUF_BLOCK_READ) size = HTBUF_BLOCK_READ;
+            octx->lobprefetch = (int)size;
+        }
+
+        sptr = str_substr(ltypes, "CACHE", 1);
+        if (sptr)
+        {
+            sptr += str_length("CACHE");
+            if (*sptr == '=') ++sptr;
+            octx->doclife = (*sptr) ? str_atoi(sptr) : CACHE_DOC_LIFE;
+            if (octx->doclife < 0) octx->doclife = 0;
+        }
     }
 }
 
@@ -2115,6 +2311,10 @@ void parse_locations(daemon_context *pdctx, char *fname, int nthreads)
                     mowa_nls(octx, find_arg(&sptr));
                 else if (!str_compare(lptr, "UploadMax", -1, 1))
                     mowa_upmx(octx, find_arg(&sptr));
+                else if (!str_compare(lptr, "ReadAhead", -1, 1))
+                    mowa_rdahd(octx, find_arg(&sptr));
+                else if (!str_compare(lptr, "WriteBehind", -1, 1))
+                    mowa_wrbhd(octx, find_arg(&sptr));
                 else if (!str_compare(lptr, "Pool", -1, 1))
                     mowa_pool(octx, find_arg(&sptr), nthreads);
                 else if (!str_compare(lptr, "Unicode", -1, 1))
@@ -2139,8 +2339,11 @@ void parse_locations(daemon_context *pdctx, char *fname, int nthreads)
                 {
                     arg1 = find_arg(&sptr);
                     arg2 = find_arg(&sptr);
-                    mowa_desc(octx, arg1, arg2);
+                    arg3 = find_arg(&sptr);
+                    mowa_desc(octx, arg1, arg2, arg3);
                 }
+                else if (!str_compare(lptr, "DescribePreload", -1, 1))
+                    octx->desc_preload = find_arg(&sptr);
                 else if (!str_compare(lptr, "Admin", -1, 1))
                 {
                     arg1 = find_arg(&sptr);
@@ -2159,6 +2362,12 @@ void parse_locations(daemon_context *pdctx, char *fname, int nthreads)
                     arg2 = find_arg(&sptr);
                     mowa_table(octx, arg1, arg2);
                 }
+                else if (!str_compare(lptr, "Spill", -1, 1))
+                {
+                    arg1 = find_arg(&sptr);
+                    arg2 = find_arg(&sptr);
+                    mowa_spill(octx, arg1, arg2);
+                }
                 else if (!str_compare(lptr, "Auth", -1, 1))
                 {
                     arg1 = find_arg(&sptr);
@@ -2177,6 +2386,24 @@ void parse_locations(daemon_context *pdctx, char *fname, int nthreads)
                     arg2 = (*sptr) ? find_arg(&sptr) : (char *)0;
                     mowa_wait(octx, arg1, arg2);
                 }
+                else if (!str_compare(lptr, "Queue", -1, 1))
+                {
+                    arg1 = find_arg(&sptr);
+                    arg2 = (*sptr) ? find_arg(&sptr) : (char *)0;
+                    mowa_queue(octx, arg1, arg2);
+                }
+                else if (!str_compare(lptr, "SessionPool", -1, 1))
+                {
+                    arg1 = find_arg(&sptr);
+                    arg2 = (*sptr) ? find_arg(&sptr) : (char *)0;
+                    arg3 = (*sptr) ? find_arg(&sptr) : (char *)0;
+                    mowa_spool(octx, arg1, arg2, arg3);
+                }
+                else if (!str_compare(lptr, "StmtCache", -1, 1))
+                {
+                    arg1 = find_arg(&sptr);
+                    mowa_stmtc(octx, arg1);
+                }
                 else if (!str_compare(lptr, "Env", -1, 1))
                 {
                     arg1 = find_arg(&sptr);
@@ -2231,6 +2458,7 @@ static void cleanup_thread(daemon_context *pdctx)
             while (octx)
             {
                 thread_check();
+                owa_desc_preload(octx);
                 owa_pool_purge(octx, t);
                 owa_file_purge(octx, t);
                 octx = octx->next;
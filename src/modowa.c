@@ -102,6 +102,25 @@
 ** 11/29/2021   D. McMahon      Default dav_mode to -1 (unconfigured)
 ** 03/07/2023   D. McMahon      Added OwaHeader
 ** 05/08/2023   D. McMahon      Fix volatile markings in the code
+** 10/17/2026   D. McMahon      Add FUSED to OwaAlternate
+** 10/17/2026   D. McMahon      Add OwaStmtCache
+** 10/17/2026   D. McMahon      Add OwaSessionPool
+** 10/17/2026   D. McMahon      Add morq_writev and STREAM to OwaAlternate
+** 10/17/2026   D. McMahon      Pass morq_writev slices as a bucket brigade
+** 10/17/2026   D. McMahon      Add morq_send_file
+** 10/17/2026   D. McMahon      Add describe cache limit to OwaDescribe
+** 10/17/2026   D. McMahon      Add OwaDescribePreload
+** 10/17/2026   D. McMahon      Add DELTA to OwaAlternate
+** 10/17/2026   D. McMahon      Run deferred package resets in cleanup thread
+** 10/17/2026   D. McMahon      Add warm floor to OwaPool, warm pool in thread
+** 10/17/2026   D. McMahon      Add OwaQueue
+** 10/17/2026   D. McMahon      Add OwaReadAhead
+** 10/17/2026   D. McMahon      Add PREFETCH to OwaDocLobs
+** 10/17/2026   D. McMahon      Add OwaWriteBehind
+** 10/17/2026   D. McMahon      Add OwaSpill, release spilled POST bodies
+** 10/17/2026   D. McMahon      Add mowa_queue_wait and mowa_queue_wake
+** 10/17/2026   D. McMahon      Add CACHE to OwaDocLobs
+** 10/17/2026   D. McMahon      Send files from a duplicate of the open handle
 */
 
 #ifdef APACHE24
@@ -186,10 +205,16 @@ struct owa_mt_context
 {
     os_objptr    c_mutex;     /* Per-process connection pool latch */
     os_objptr    c_semaphore; /* Per-process connection pool queue */
+    os_objptr   *q_signals;   /* Admission queue wakeups, by ticket */
 };
 
 AP_MODULE_DECLARE_DATA module owa_module;
 
+/*
+** Wakes the cleanup thread for deferred resets and pool warming
+*/
+static os_objptr thread_signal = os_nullmutex;
+
 #ifdef CHECK_ERRNO
 #define RESET_ERRNO os_set_errno(0)
 #else
@@ -229,14 +254,35 @@ void mowa_release_mutex(owa_context *octx)
 
 void mowa_semaphore_create(owa_context *octx)
 {
+    int i;
+
     if ((octx->poolsize > 0) && (octx->poolsize <= MAX_POOL))
         octx->mtctx->c_semaphore = os_cond_init((char *)0, octx->poolsize, 1);
+
+    /*
+    ** Each admission queue position gets a wakeup of its own, so that
+    ** the request leaving the head of the line can wake just the next
+    ** one.  They're created with a count of 1 (a count of 0 isn't
+    ** allowed on Windows) and drained straight away.
+    */
+    if ((octx->q_limit > 0) && (octx->multithread))
+    {
+        octx->mtctx->q_signals =
+            (os_objptr *)mem_zalloc(sizeof(os_objptr) * octx->q_limit);
+        if (octx->mtctx->q_signals)
+            for (i = 0; i < octx->q_limit; ++i)
+            {
+                octx->mtctx->q_signals[i] = os_cond_init((char *)0, 1, 1);
+                if (!InvalidMutex(octx->mtctx->q_signals[i]))
+                    os_cond_wait(octx->mtctx->q_signals[i], 0);
+            }
+    }
 }
 
-int mowa_semaphore_get(owa_context *octx)
+int mowa_semaphore_get(owa_context *octx, int wait_ms)
 {
     if ((octx->poolsize > 0) && (octx->poolsize <= MAX_POOL))
-        return(os_cond_wait(octx->mtctx->c_semaphore, octx->pool_wait_ms));
+        return(os_cond_wait(octx->mtctx->c_semaphore, wait_ms));
     return(1);
 }
 
@@ -246,6 +292,56 @@ void mowa_semaphore_put(owa_context *octx)
         os_cond_signal(octx->mtctx->c_semaphore);
 }
 
+/*
+** Wait up to wait_ms for the admission queue to reach a ticket.
+** The wakeup can be stale, so the caller has to recheck the queue.
+*/
+int mowa_queue_wait(owa_context *octx, int ticket, int wait_ms)
+{
+    os_objptr qsig = os_nullmutex;
+
+    if (octx->mtctx->q_signals)
+        qsig = octx->mtctx->q_signals[ticket % octx->q_limit];
+    if (InvalidMutex(qsig))
+    {
+        os_milli_sleep(QUEUE_POLL_MS);
+        return(0);
+    }
+    return(os_cond_wait(qsig, wait_ms));
+}
+
+/*
+** Wake the request holding a ticket, once it's at the head of the line
+*/
+void mowa_queue_wake(owa_context *octx, int ticket)
+{
+    os_objptr qsig;
+
+    if (!(octx->mtctx->q_signals)) return;
+    qsig = octx->mtctx->q_signals[ticket % octx->q_limit];
+    if (!InvalidMutex(qsig)) os_cond_signal(qsig);
+}
+
+/*
+** Package resets can be handed to the cleanup thread only if it's
+** running and the pool has a latch to guard the hand-off.
+*/
+int mowa_reset_async(owa_context *octx)
+{
+    if (InvalidMutex(thread_signal)) return(0);
+    if (InvalidMutex(octx->mtctx->c_mutex)) return(0);
+    return(1);
+}
+
+/*
+** Wake the cleanup thread early, if there is one
+*/
+void mowa_thread_wake(owa_context *octx)
+{
+    if (!InvalidMutex(thread_signal))
+        os_cond_signal(thread_signal);
+}
+
 /*****************************************************************************\
  * Request-based functions                                                   *
 \*****************************************************************************/
@@ -455,6 +551,100 @@ long morq_write(request_rec *request, char *buffer, long buflen)
     return(buflen);
 }
 
+/*
+** Write an array of fixed-width slices, each with its own length.
+** The slices are wrapped in transient buckets and passed down the
+** filter chain as one brigade, so the core output filter can write
+** them with a single writev (any filter that needs to hold on to
+** the data will copy it as it sets the buckets aside).  Any output
+** still buffered by ap_rwrite is prepended by the old-write filter,
+** so ordering is preserved.
+*/
+long morq_writev(request_rec *request, char *buffer, int stride,
+                 un_short *lens, int nvec)
+{
+    apr_bucket_brigade *bb;
+    apr_bucket         *b;
+    long                total = 0;
+    int                 i;
+
+    bb = apr_brigade_create(request->pool, request->connection->bucket_alloc);
+    for (i = 0; i < nvec; ++i)
+    {
+        if (lens[i] > 0)
+        {
+            b = apr_bucket_transient_create(buffer, (apr_size_t)lens[i],
+                                            bb->bucket_alloc);
+            APR_BRIGADE_INSERT_TAIL(bb, b);
+            total += (long)lens[i];
+        }
+        buffer += stride;
+    }
+    if (total > 0)
+        if (ap_pass_brigade(request->output_filters, bb) != APR_SUCCESS)
+            total = -1;
+    apr_brigade_destroy(bb);
+    return(total);
+}
+
+/*
+** Close a file handed to APR by morq_send_file, when the request
+** pool is destroyed
+*/
+static apr_status_t mowa_file_close(void *ctx)
+{
+    apr_file_close((apr_file_t *)ctx);
+    return(APR_SUCCESS);
+}
+
+/*
+** Send part of a file using a file bucket, so that the core output
+** filter can use sendfile.  The bucket gets a duplicate of the
+** caller's handle, so the bytes sent come from the same file that
+** the caller sized, even if the path has since been replaced.  The
+** duplicate belongs to the request pool, which keeps it open for as
+** long as any filter holds the bucket.  Returns SEND_FILE_UNAVAILABLE
+** if the handle can't be duplicated, in which case the caller should
+** copy the file, or SEND_FILE_FAILED if the transfer fails.
+*/
+long_64 morq_send_file(request_rec *request, char *fpath, os_objhand fp,
+                       long_64 off, long_64 len)
+{
+    apr_file_t         *afile = (apr_file_t *)0;
+    apr_bucket_brigade *bb;
+    os_objhand          dfp;
+#ifndef APACHE22
+    apr_bucket         *b;
+#endif
+
+    dfp = file_dup(fp);
+    if (InvalidFile(dfp)) return(SEND_FILE_UNAVAILABLE);
+    if (apr_os_file_put(&afile, &dfp,
+                        APR_READ | APR_BINARY | APR_SENDFILE_ENABLED,
+                        request->pool) != APR_SUCCESS)
+    {
+        file_close(dfp);
+        return(SEND_FILE_UNAVAILABLE);
+    }
+    apr_pool_cleanup_register(request->pool, (void *)afile,
+                              mowa_file_close, apr_pool_cleanup_null);
+
+    bb = apr_brigade_create(request->pool, request->connection->bucket_alloc);
+#ifdef APACHE22
+    apr_brigade_insert_file(bb, afile, (apr_off_t)off, (apr_off_t)len,
+                            request->pool);
+#else
+    /* ### Older APR can't split files over 2G into multiple buckets ### */
+    b = apr_bucket_file_create(afile, (apr_off_t)off, (apr_size_t)len,
+                               request->pool, bb->bucket_alloc);
+    APR_BRIGADE_INSERT_TAIL(bb, b);
+#endif
+    if (ap_pass_brigade(request->output_filters, bb) != APR_SUCCESS)
+        len = SEND_FILE_FAILED;
+    apr_brigade_destroy(bb);
+    return(len);
+}
+
 void morq_print_int(request_rec *request, char *fmt, long ival)
 {
     ap_rprintf(request, fmt, ival);
@@ -626,6 +816,9 @@ static void oracle_thread(void *tctx)
     oracle_config * volatile cfg = (oracle_config *)tctx;
     owa_context   * volatile octx;
     int                     t;
+    int                     purge_flag;
+    un_long                 tnow;
+    un_long                 tnext = 0;
 
     thread_block_signals();
 
@@ -645,6 +838,16 @@ static void oracle_thread(void *tctx)
 
             if (!InvalidMutex(cfg->o_mutex))
                 os_mutex_release(cfg->o_mutex);
+
+            /*
+            ** Deferred package resets, pool warming, and the describe
+            ** preload are run on every wakeup; the purges only once per
+            ** poll interval.
+            */
+            tnow = os_get_time((un_long *)0);
+            purge_flag = (tnow >= tnext);
+            if (purge_flag)
+                tnext = tnow + (un_long)((t < 1000000) ? t : (t / 1000));
  
             /*
             ** ### There is some possibility that exit
@@ -656,9 +859,15 @@ static void oracle_thread(void *tctx)
             {
                 thread_check();
                 if (octx->init_complete)
+                    owa_pool_reset((owa_context *)octx);
+                if (octx->init_complete)
+                    owa_pool_warm((owa_context *)octx);
+                if (octx->init_complete)
+                    owa_desc_preload((owa_context *)octx);
+                if ((octx->init_complete) && (purge_flag))
                     owa_pool_purge((owa_context *)octx, t);
 #ifndef NO_FILE_CACHE
-                if (octx->init_complete)
+                if ((octx->init_complete) && (purge_flag))
                     owa_file_purge((owa_context *)octx, t);
 #endif
                 octx = octx->next;
@@ -667,7 +876,10 @@ static void oracle_thread(void *tctx)
 
         t = cfg->tinterval;
         if (t < 1000000) t *= 1000;
-        os_milli_sleep(t);
+        if (InvalidMutex(thread_signal))
+            os_milli_sleep(t);
+        else
+            os_cond_wait(thread_signal, t);
     }
     thread_exit();
 }
@@ -772,6 +984,7 @@ static int mowa_handler(request_rec *r)
 
         post_flag = get_dav_method(r->method_number);
         result = owa_handle_request(octx, r, r->args, post_flag, &owa_req);
+        owa_free_args(&owa_req);
 
         RESET_ERRNO;
         /* ### Revisit the use of floating-point below ### */
@@ -841,8 +1054,11 @@ static const char *mowa_diag(cmd_parms *cmd, owa_context *octx, char *dstr)
 }
 
 static const char *mowa_desc(cmd_parms *cmd, owa_context *octx,
-                             char *dstr, char *schema)
+                             char *dstr, char *schema, char *maxstr)
 {
+    int   n;
+    char *sptr;
+
     /*
     ** Parse and set the describe mode and schema
     */
@@ -859,6 +1075,15 @@ static const char *mowa_desc(cmd_parms *cmd, owa_context *octx,
     }
     if (schema) octx->desc_schema = schema;
 
+    /* Optional limit on the number of cached describe results */
+    if (maxstr)
+    {
+        n = 0;
+        for (sptr = maxstr; ((*sptr >= '0') && (*sptr <= '9')); ++sptr)
+            n = n * 10 + (*sptr - '0');
+        octx->desc_max = n;
+    }
+
     return((char *)0);
 }
 
@@ -895,6 +1120,12 @@ static const char *mowa_alt(cmd_parms *cmd, owa_context *octx, char *astr)
             octx->altflags |= ALT_MODE_CGIPOST;
         else if (str_substr(astr, "IPADDR",  1))
             octx->altflags |= ALT_MODE_IPADDR;
+        else if (str_substr(astr, "FUSED",  1))
+            octx->altflags |= ALT_MODE_FUSED;
+        else if (str_substr(astr, "STREAM",  1))
+            octx->altflags |= ALT_MODE_STREAM;
+        else if (str_substr(astr, "DELTA",  1))
+            octx->altflags |= ALT_MODE_DELTA;
     }
 
     return((char *)0);
@@ -1061,7 +1292,44 @@ static const char *mowa_upmx(cmd_parms *cmd, owa_context *octx, char *umaxstr)
     return((char *)0);
 }
 
-static const char *mowa_pool(cmd_parms *cmd, owa_context *octx, char *poolstr)
+static const char *mowa_rdahd(cmd_parms *cmd, owa_context *octx, char *sizestr)
+{
+    /*
+    ** Set the block size for pipelined LOB downloads
+    */
+    octx->readahead = (sizestr) ? str_to_mem(sizestr) : 0;
+    if (octx->readahead > HTBUF_READ_AHEAD)
+        octx->readahead = HTBUF_READ_AHEAD;
+
+    return((char *)0);
+}
+
+static const char *mowa_wrbhd(cmd_parms *cmd, owa_context *octx, char *sizestr)
+{
+    /*
+    ** Set the slot size for pipelined LOB uploads
+    */
+    octx->writebehind = (sizestr) ? str_to_mem(sizestr) : 0;
+    if (octx->writebehind > HTBUF_WRITE_BEHIND)
+        octx->writebehind = HTBUF_WRITE_BEHIND;
+
+    return((char *)0);
+}
+
+static const char *mowa_spill(cmd_parms *cmd, owa_context *octx,
+                              char *sizestr, char *dirstr)
+{
+    /*
+    ** Set the size above which POST bodies go to a temp file
+    */
+    octx->spillsize = (sizestr) ? str_to_mem(sizestr) : 0;
+    octx->spilldir = dirstr;
+
+    return((char *)0);
+}
+
+static const char *mowa_pool(cmd_parms *cmd, owa_context *octx,
+                             char *poolstr, char *minstr)
 {
     int         poolsize;
     int         oldsize;
@@ -1098,6 +1366,14 @@ static const char *mowa_pool(cmd_parms *cmd, owa_context *octx, char *poolstr)
         }
     }
 
+    if (minstr)
+    {
+        octx->pool_min = 0;
+        for (sptr = minstr; ((*sptr >= '0') && (*sptr <= '9')); ++sptr)
+            octx->pool_min = octx->pool_min * 10 + (*sptr - '0');
+        if (octx->pool_min > MAX_POOL) octx->pool_min = MAX_POOL;
+    }
+
     return((char *)0);
 }
 
@@ -1122,6 +1398,70 @@ static const char *mowa_wait(cmd_parms *cmd, owa_context *octx,
     return((char *)0);
 }
 
+static const char *mowa_queue(cmd_parms *cmd, owa_context *octx,
+                              char *limitstr, char *retrystr)
+{
+    char *sptr;
+
+    octx->q_limit = 0;
+    for (sptr = limitstr; ((*sptr >= '0') && (*sptr <= '9')); ++sptr)
+        octx->q_limit = octx->q_limit * 10 + (*sptr - '0');
+
+    if (retrystr)
+    {
+        octx->q_retry = 0;
+        for (sptr = retrystr; ((*sptr >= '0') && (*sptr <= '9')); ++sptr)
+            octx->q_retry = octx->q_retry * 10 + (*sptr - '0');
+    }
+
+    return((char *)0);
+}
+
+static const char *mowa_stmtc(cmd_parms *cmd, owa_context *octx,
+                              char *sizestr)
+{
+    int   nstmts = 0;
+    char *sptr;
+
+    for (sptr = sizestr; ((*sptr >= '0') && (*sptr <= '9')); ++sptr)
+        nstmts = nstmts * 10 + (*sptr - '0');
+    octx->stmt_cache = nstmts;
+
+    return((char *)0);
+}
+
+static const char *mowa_spool(cmd_parms *cmd, owa_context *octx,
+                              char *minstr, char *maxstr, char *incrstr)
+{
+    int   n;
+    char *sptr;
+
+    n = 0;
+    for (sptr = minstr; ((*sptr >= '0') && (*sptr <= '9')); ++sptr)
+        n = n * 10 + (*sptr - '0');
+    octx->spool_min = n;
+
+    /* Zero means use the size of the connection pool */
+    n = 0;
+    if (maxstr)
+        for (sptr = maxstr; ((*sptr >= '0') && (*sptr <= '9')); ++sptr)
+            n = n * 10 + (*sptr - '0');
+    octx->spool_max = n;
+
+    /* A non-zero increment also marks session pool mode as enabled */
+    n = 1;
+    if (incrstr)
+    {
+        n = 0;
+        for (sptr = incrstr; ((*sptr >= '0') && (*sptr <= '9')); ++sptr)
+            n = n * 10 + (*sptr - '0');
+        if (n <= 0) n = 1;
+    }
+    octx->spool_incr = n;
+
+    return((char *)0);
+}
+
 static const char *mowa_uid(cmd_parms *cmd, owa_context *octx, char *uid)
 {
     char *sptr;
@@ -1154,7 +1494,9 @@ static const char *mowa_uid(cmd_parms *cmd, owa_context *octx, char *uid)
 
 static const char *mowa_lobs(cmd_parms *cmd, owa_context *octx, char *ltypes)
 {
-    int lobtypes = 0;
+    int      lobtypes = 0;
+    long_64  size;
+    char    *sptr;
 
     if (ltypes)
     {
@@ -1168,6 +1510,25 @@ static const char *mowa_lobs(cmd_parms *cmd, owa_context *octx, char *ltypes)
             octx->lontypes = LONG_MODE_RETURN_LEN;
         else if (str_substr(ltypes, "LONG_FETCH_LENGTH", 1))
             octx->lontypes = LONG_MODE_FETCH_LEN;
+
+        sptr = str_substr(ltypes, "PREFETCH", 1);
+        if (sptr)
+        {
+            sptr += str_length("PREFETCH");
+            if (*sptr == '=') ++sptr;
+            size = (*sptr) ? str_to_mem(sptr) : (long_64)HTBUF_BLOCK_SIZE;
+            if (size > (long_64)HTBUF_BLOCK_READ) size = HTBUF_BLOCK_READ;
+            octx->lobprefetch = (int)size;
+        }
+
+        sptr = str_substr(ltypes, "CACHE", 1);
+        if (sptr)
+        {
+            sptr += str_length("CACHE");
+            if (*sptr == '=') ++sptr;
+            octx->doclife = (*sptr) ? str_atoi(sptr) : CACHE_DOC_LIFE;
+            if (octx->doclife < 0) octx->doclife = 0;
+        }
     }
 
     return((char *)0);
@@ -1684,6 +2045,7 @@ static apr_status_t oracle_exit(void *data)
     oracle_config * volatile cfg;
     owa_context   *octx;
     int            latch = 0;
+    int            i;
 
     cfg = (oracle_config *)ap_get_module_config(s->module_config, &owa_module);
 
@@ -1700,6 +2062,7 @@ static apr_status_t oracle_exit(void *data)
           if (latch)
           {
             cfg->tinterval = 0; /* Trigger exit from cleanup thread */
+            thread_signal = os_nullmutex; /* Stop deferring resets */
 
             for (octx = cfg->loc_list; octx; octx = octx->next)
             {
@@ -1714,6 +2077,14 @@ static apr_status_t oracle_exit(void *data)
                   os_mutex_destroy(octx->mtctx->c_mutex);
               if (!InvalidMutex(octx->mtctx->c_semaphore))
                   os_cond_destroy(octx->mtctx->c_semaphore);
+              if (octx->mtctx->q_signals)
+              {
+                  for (i = 0; i < octx->q_limit; ++i)
+                      if (!InvalidMutex(octx->mtctx->q_signals[i]))
+                          os_cond_destroy(octx->mtctx->q_signals[i]);
+                  mem_free((void *)(octx->mtctx->q_signals));
+                  octx->mtctx->q_signals = (os_objptr *)0;
+              }
             }
             cfg->loc_list = (owa_context *)0;
 
@@ -1873,9 +2244,14 @@ static void oracle_init(apr_pool_t *p, server_rec *s)
         }
         if (cfg->tinterval > 0)
         {
+            /* Binary wakeup, so a count of 1 is enough */
+            thread_signal = os_cond_init((char *)0, 1, 1);
             cfg->thand = thread_spawn(oracle_thread, (void *)cfg, &(cfg->tid));
             if (InvalidThread(cfg->thand))
             {
+                if (!InvalidMutex(thread_signal))
+                    os_cond_destroy(thread_signal);
+                thread_signal = os_nullmutex;
                 cfg->tinterval = 0;
                 ap_log_error(APLOG_MARK, APLOG_ERR, LOGSTATUS(s),
                              "Cleanup thread creation error in PID %d",
@@ -1933,18 +2309,26 @@ ARG_PATTERN("OwaNLS",          ARG_FN(mowa_nls),    ACCESS_CONF,   TAKE1,
             "OwaNLS [language][_territory][.]<characterset>"           ),
 ARG_PATTERN("OwaAuth",         ARG_FN(mowa_ver),    ACCESS_CONF,  TAKE12,
             "OwaAuth [OWA_INIT or OWA_CUSTOM] [PACKAGE]"               ),
-ARG_PATTERN("OwaPool",         ARG_FN(mowa_pool),   ACCESS_CONF,   TAKE1,
-            "OwaPool <poolsize, range 0-255, or THREADS>"              ),
+ARG_PATTERN("OwaPool",         ARG_FN(mowa_pool),   ACCESS_CONF,  TAKE12,
+            "OwaPool <poolsize, range 0-255, or THREADS> [warm floor]" ),
 ARG_PATTERN("OwaWait",         ARG_FN(mowa_wait),   ACCESS_CONF,  TAKE12,
             "OwaWait <milliseconds> [ABORT]"                           ),
+ARG_PATTERN("OwaQueue",        ARG_FN(mowa_queue),  ACCESS_CONF,  TAKE12,
+            "OwaQueue <max waiting requests> [Retry-After seconds]"    ),
+ARG_PATTERN("OwaSessionPool",  ARG_FN(mowa_spool),  ACCESS_CONF, TAKE123,
+            "OwaSessionPool <min sessions> [max sessions] [increment]" ),
+ARG_PATTERN("OwaStmtCache",    ARG_FN(mowa_stmtc),  ACCESS_CONF,   TAKE1,
+            "OwaStmtCache <statements cached per connection>"          ),
 ARG_PATTERN("OwaOptimizer",    ARG_SET(optimizer_mode),ACCESS_CONF,TAKE1,
             "OwaOptimizer <optimizer mode>"                            ),
 ARG_PATTERN("OwaDiag",         ARG_FN(mowa_diag),   ACCESS_CONF, ITERATE,
             "OwaDiag [diagnostics]"                                    ),
 ARG_PATTERN("OwaLog",          ARG_SET(diagfile),   ACCESS_CONF,   TAKE1,
             "OwaLog <filepath/name>"                                   ),
-ARG_PATTERN("OwaDescribe",     ARG_FN(mowa_desc),   ACCESS_CONF,  TAKE12,
-            "OwaDescribe <mode> [schema]"                              ),
+ARG_PATTERN("OwaDescribe",     ARG_FN(mowa_desc),   ACCESS_CONF, TAKE123,
+            "OwaDescribe <mode> [schema] [cache limit]"                ),
+ARG_PATTERN("OwaDescribePreload",ARG_SET(desc_preload),ACCESS_CONF,TAKE1,
+            "OwaDescribePreload <procedure list file or query>"        ),
 ARG_PATTERN("OwaAlternate",    ARG_FN(mowa_alt),    ACCESS_CONF, ITERATE,
             "OwaAlternate <package name> [options]"                    ),
 ARG_PATTERN("OwaUnicode",      ARG_FN(mowa_uni),    ACCESS_CONF,   TAKE1,
@@ -2005,6 +2389,12 @@ ARG_PATTERN("OwaSession",      ARG_SET(session),    ACCESS_CONF,   TAKE1,
             "OwaSession <session cookie name>"                         ),
 ARG_PATTERN("OwaUploadMax",    ARG_FN(mowa_upmx),   ACCESS_CONF,   TAKE1,
             "OwaUploadMax <maximum upload size>"                       ),
+ARG_PATTERN("OwaReadAhead",    ARG_FN(mowa_rdahd),  ACCESS_CONF,   TAKE1,
+            "OwaReadAhead <LOB download block size>"                   ),
+ARG_PATTERN("OwaWriteBehind",  ARG_FN(mowa_wrbhd),  ACCESS_CONF,   TAKE1,
+            "OwaWriteBehind <LOB upload slot size>"                    ),
+ARG_PATTERN("OwaSpill",        ARG_FN(mowa_spill),  ACCESS_CONF,   TAKE2,
+            "OwaSpill <POST body spill size> <temp directory>"         ),
 ARG_PATTERN("OwaCharset",      ARG_FN(mowa_dad),    ACCESS_CONF,   TAKE1,
             "OwaCharset <iso character set name>"                      ),
 ARG_PATTERN("OwaBindset",      ARG_SET(defaultcs),  ACCESS_CONF,   TAKE1,
@@ -116,6 +116,40 @@
 ** 03/30/2022   D. McMahon      Increase HTBUF_ENV_MAX to 8000
 ** 03/07/2023   D. McMahon      Added OwaHeader
 ** 05/08/2023   D. McMahon      Add sql_set_nls()
+** 10/17/2026   D. McMahon      Add ALT_MODE_FUSED and fuse_stmt
+** 10/17/2026   D. McMahon      Add OCI statement cache support
+** 10/17/2026   D. McMahon      Add OCI session pool settings
+** 10/17/2026   D. McMahon      Add per-state pool lists and session hash
+** 10/17/2026   D. McMahon      Add session affinity counters
+** 10/17/2026   D. McMahon      Add ALT_MODE_STREAM and morq_writev
+** 10/17/2026   D. McMahon      Add owa_shmem_get and owa_shmem_put
+** 10/17/2026   D. McMahon      Add file_stat and mapped file cache
+** 10/17/2026   D. McMahon      Add morq_send_file and socket_sendfile
+** 10/17/2026   D. McMahon      Hash the describe cache
+** 10/17/2026   D. McMahon      Add shared describe cache routines
+** 10/17/2026   D. McMahon      Add OwaDescribePreload
+** 10/17/2026   D. McMahon      Add ALT_MODE_DELTA and connection env hashes
+** 10/17/2026   D. McMahon      Add C_LOCK_RESET for deferred package resets
+** 10/17/2026   D. McMahon      Add pool warm floor and owa_pool_warm
+** 10/17/2026   D. McMahon      Add OwaQueue admission queue and statistics
+** 10/17/2026   D. McMahon      Pass CGI environment as string pointers
+** 10/17/2026   D. McMahon      Add OwaReadAhead LOB download block size
+** 10/17/2026   D. McMahon      Add PREFETCH to OwaDocLobs
+** 10/17/2026   D. McMahon      Add batched document prefetch
+** 10/17/2026   D. McMahon      Add OwaWriteBehind LOB upload block size
+** 10/17/2026   D. McMahon      Add OwaSpill and spilled POST body mapping
+** 10/17/2026   D. McMahon      Add owa_shmem_purge
+** 10/17/2026   D. McMahon      Separate send_file open and send failures
+** 10/17/2026   D. McMahon      Reclaim describe entries by epoch
+** 10/17/2026   D. McMahon      Add owa_shmem_desc_clears
+** 10/17/2026   D. McMahon      Add owa_desc_preload
+** 10/17/2026   D. McMahon      Keep a copy of the last CGI env sent
+** 10/17/2026   D. McMahon      Add admission queue wakeups
+** 10/17/2026   D. McMahon      Key prefetched documents by user
+** 10/17/2026   D. McMahon      Drop post_file, spilled bodies are unlinked early
+** 10/17/2026   D. McMahon      Make document prefetch caching opt-in
+** 10/17/2026   D. McMahon      Add file_dup
+** 10/17/2026   D. McMahon      Move the argument index to owautil.c
 */
 
 #ifndef MODOWA_H
@@ -302,6 +336,9 @@ typedef struct request_rec request_rec;
 #define ALT_MODE_CGIPOST  0x0100    /* Pass POST args to CGI       */
 #define ALT_MODE_LOGGING  0x0200    /* Enable logging callback     */
 #define ALT_MODE_IPADDR   0x0400    /* Pass client IP address      */
+#define ALT_MODE_FUSED    0x0800    /* Fuse CGI env into user call */
+#define ALT_MODE_STREAM   0x1000    /* Flush each GET_PAGE batch   */
+#define ALT_MODE_DELTA    0x2000    /* Send only changed CGI vars  */
 
 /*
 ** Describe mode flags
@@ -349,6 +386,9 @@ typedef struct request_rec request_rec;
 #define CACHE_DEF_LIFE      0x7FFFFFFF  /* Infinite life                 */
 #define CACHE_MAX_SIZE      0x1000000   /* Largest file size 16M         */
 #define CACHE_MAX_ALIASES   8           /* Reallocation unit for aliases */
+#define CACHE_DOC_LIFE      60          /* Default prefetched doc life   */
+#define CACHE_DOC_BATCH     16          /* Documents per prefetch query  */
+#define CACHE_DOC_BYTES     0x100000    /* Bytes read per prefetch query */
 
 /*
 ** Buffer sizes
@@ -360,6 +400,8 @@ typedef struct request_rec request_rec;
 #define HTBUF_PLSQL_MAX    32512    /* Maximum size of PL/SQL string  */
 #define HTBUF_BLOCK_SIZE   32768    /* Size of a file upload block    */
 #define HTBUF_BLOCK_READ   65536    /* Size of a file download block  */
+#define HTBUF_READ_AHEAD 0x800000   /* Largest OwaReadAhead block 8M  */
+#define HTBUF_WRITE_BEHIND 0x200000 /* Largest OwaWriteBehind slot 2M */
 #define HTBUF_PARAM_CHUNK     64    /* Increment for parameter allocs */
 #define HTBUF_ENV_MAX   (HTBUF_HEADER_MAX*2)
 #define HTBUF_ENV_NAM   80          /* HTTP header element name size  */
@@ -397,9 +439,23 @@ typedef struct request_rec request_rec;
 #define C_LOCK_AVAILABLE        2
 #define C_LOCK_INUSE            3
 #define C_LOCK_OFFLINE          4
+#define C_LOCK_RESET            5   /* Idle, package reset pending */
 #define C_LOCK_UNKNOWN          7
 #define C_LOCK_MAXIMUM          8
 
+/*
+** Admission queue statistics (see OwaQueue)
+*/
+#define QUEUE_BUCKETS           16  /* Wait histogram, power-of-2 ms  */
+#define QUEUE_POLL_MS           5   /* Fallback poll if no wakeups    */
+#define QSTAT_DEPTH             0   /* Requests waiting now           */
+#define QSTAT_SHED              1   /* Requests turned away with 503  */
+#define QSTAT_WAITS             2   /* Start of the wait histogram    */
+#define QSTAT_SIZE              (QSTAT_WAITS + QUEUE_BUCKETS)
+
+#define POOL_HASH_SIZE          256  /* Session hash buckets, power of 2 */
+#define DESC_HASH_SIZE          256  /* Describe cache hash buckets      */
+
 /*
 ** Shared memory constants
 */
@@ -481,6 +537,7 @@ typedef struct request_rec request_rec;
 #endif
 
 #define un_long unsigned long
+#define un_short unsigned short
 
 #ifdef MODOWA_WINDOWS
 #define long_64 _int64
@@ -509,16 +566,26 @@ typedef struct arg_record
 typedef struct env_record
 {
     int      count;
-    char    *names;
-    char    *values;
-    int      nwidth;
-    int      vwidth;
+    char   **names;   /* Pointers to the names, bound by pointer */
+    char   **values;  /* Pointers to the values, bound by pointer */
+    int      nwidth;  /* Maximum name length + 1 */
+    int      vwidth;  /* Maximum value length + 1 */
     char    *authuser;
     char    *authpass;
     char    *session;
     un_long  ipaddr;
 } env_record;
 
+/*
+** Precomputed search pattern (e.g. a multipart boundary)
+*/
+typedef struct mem_pattern
+{
+    const char *pat;
+    int         plen;
+    int         skip[256]; /* Horspool shift indexed by the last byte */
+} mem_pattern;
+
 /*
 ** Timestamp structure
 */
@@ -560,6 +627,15 @@ struct owa_log_socks
 ** Handle to hold OCI connection information
 */
 typedef struct connection connection;
+
+/*
+** Intrusive list of connection pool slots (see owacache.c)
+*/
+typedef struct pool_list
+{
+    connection *head;              /* Most recently used */
+    connection *tail;              /* Least recently used */
+} pool_list;
 #ifdef WITH_OCI
 /* ### EVENTUALLY, MOVE ENTIRELY INTO owasql.c ### */
 struct connection
@@ -574,6 +650,7 @@ struct connection
     OCIStmt       *stmhp3;
     OCIStmt       *stmhp4;
     OCIStmt       *stmhp5;
+    OCIStmt       *stmhpc;         /* Statement from OCI statement cache */
     OCILobLocator *pblob;
     OCILobLocator *pclob;
     OCILobLocator *pnlob;
@@ -595,6 +672,20 @@ struct connection
     ub2            rcode;
     owa_log_socks *sockctx;        /* Back-pointer to logging sockets */
     int            slotnum;
+    OCIAuthInfo   *authp;          /* Credentials for session pool get */
+    int            spooled;        /* Session drawn from shared pool */
+    connection    *c_next;         /* Pool list links */
+    connection    *c_prev;
+    connection    *c_hnext;        /* Session hash chain */
+    ub4            stmtcache;      /* OCI statement cache size, 0 if off */
+    un_long        stmt_hits;      /* Statement cache hits */
+    un_long        stmt_misses;    /* Statement cache misses */
+    char          *env_copy;       /* Copy of the last CGI env sent */
+    int            env_size;       /* Allocated bytes in env_copy */
+    int            env_count;      /* CGI vars known to session, 0 if none */
+    un_long        env_ip;         /* Client IP address last sent */
+    int            reset_due;      /* Package reset owed before use */
+    char          *docnames;       /* Documents announced for prefetch */
 };
 
 #ifndef OCI_UCS2ID
@@ -650,7 +741,11 @@ struct descstruct
     char       *pname;  /* Procedure or package name */
     char       *pargs;  /* Collection bind argument names */
     int         flex2;  /* Flags 2-argument flex mode */
-    descstruct *next;   /* Next describe result */
+    un_long     hashval;
+    un_long     lastuse;
+    descstruct *next;   /* Next describe result in hash chain */
+    descstruct *rnext;  /* Next retired result awaiting free */
+    int         rgen;   /* Epoch in which it was retired */
 };
 
 /*
@@ -695,6 +790,9 @@ typedef struct owa_request
     char    *post_args;
     char    *logbuffer;
     int      loglength;
+    char    *post_map;      /* POST body spilled to a mapped temp file */
+    un_long  post_size;
+    os_objhand post_hnd;
 } owa_request;
 
 /*
@@ -723,6 +821,7 @@ struct owa_context
     int             diagflag;
     int             descmode;
     char           *desc_schema;
+    char           *desc_preload;   /* Procedure manifest file or query */
     char           *alternate;
     int             altflags;
     int             rsetflag;
@@ -739,9 +838,15 @@ struct owa_context
     char           *defaultcs;
     int             poolsize;
     long_64         upmax;
+    long_64         readahead;      /* LOB download block, 0 if serial */
+    long_64         writebehind;    /* LOB upload slot, 0 if serial    */
+    long_64         spillsize;      /* POST body spill threshold, or 0 */
+    char           *spilldir;       /* Directory for spilled POST bodies */
     int             version;
     int             lobtypes;
     int             lontypes;
+    int             lobprefetch;    /* Bytes of document LOB prefetched */
+    int             doclife;        /* Life of prefetched documents, or 0 */
     int             nls_init;
     int             ora_csid;
     int             dad_csid;
@@ -758,13 +863,35 @@ struct owa_context
     int             realpid;
     int             pool_wait_ms;
     int             pool_wait_abort;
+    int             pool_min;       /* Connections kept open (warm floor) */
+    int             pool_peak;      /* Recent peak of connections in use */
+    int             q_limit;        /* Admission queue length, 0 if none */
+    int             q_retry;        /* Retry-After seconds for a 503 */
+    int             q_head;         /* Next queue ticket to be served */
+    int             q_tail;         /* Next queue ticket to be issued */
+    int             qstats[QSTAT_SIZE];
+    int             stmt_cache;
+    int             spool_min;
+    int             spool_max;
+    int             spool_incr;
+    void           *spool;          /* ### Written at run-time */
     char           *optimizer_mode;
     connection     *c_pool;
     int             poolstats[C_LOCK_MAXIMUM];
+    pool_list       c_unused;       /* Slots with no connection */
+    pool_list       c_free;         /* Available, no session */
+    pool_list       c_sess;         /* Available, with session */
+    pool_list       c_reset;        /* Idle, package reset pending */
+    connection     *c_hash[POOL_HASH_SIZE];
+    un_long         sess_lookups;   /* Session-matching requests */
+    un_long         sess_hits;      /* Requests matched to their session */
+    un_long         sess_evicts;    /* Sessions taken over by another */
     char           *reset_stmt;
     char            cgi_stmt[512];
     char            sec_stmt[512];
     char            get_stmt[512];
+    char            fuse_stmt[1024];
+    char            delta_stmt[512];
     char           *lob_stmt;
     char           *cpmv_stmt;
     char           *res_stmt;
@@ -789,9 +916,19 @@ struct owa_context
     char           *logbuffer;
     char           *default_ctype;
     char           *error_ctype;
-    descstruct     *desc_cache;
+    descstruct     *desc_hash[DESC_HASH_SIZE];
+    descstruct     *desc_retired;   /* Unlinked, may still be in use */
+    int             desc_max;       /* Describe cache size limit */
+    int             desc_count;
+    int             desc_readers[2];/* Lookups in progress, by epoch */
+    int             desc_epoch;     /* Describe reclamation epoch */
+    int             desc_clock;
+    int             desc_gen;       /* Last shared describe generation */
+    int             desc_clears;    /* Last shared describe clear count */
+    int             desc_loaded;    /* Preload done by cleanup thread */
     ldapstruct     *ldap_cache;
     shm_context    *mapmem;
+    void           *fmaps;          /* ### Written at run-time */
     owa_context    *next;
 };
 
@@ -846,6 +983,40 @@ typedef struct http_args
     file_arg  *filelist; /* Linked list of file upload arguments */
 } http_args;
 
+/*
+** Argument arrays start at HTBUF_PARAM_CHUNK entries and double in
+** size, so a request with thousands of arguments doesn't spend its
+** time copying.  An array of n entries is full when n is a power of 2.
+*/
+#define ARR_GROWTH(n) (((n) < HTBUF_PARAM_CHUNK) ? HTBUF_PARAM_CHUNK : (n))
+#define ARR_FULL(n)   (((n) >= HTBUF_PARAM_CHUNK) && (((n) & ((n) - 1)) == 0))
+
+/*
+** Element count of a collection argument; the same type as the OCI
+** ub4 it's bound as, without needing the OCI headers
+*/
+#ifdef WITH_OCI
+#define arg_count ub4
+#else
+#define arg_count unsigned int
+#endif
+
+/*
+** Index of argument names, used to find repeated arguments without
+** comparing every name to every other name.  It's an open-addressed
+** hash table of argument positions.  Memory comes from afunc, which
+** in the server allocates from the request pool.
+*/
+typedef struct arg_index
+{
+    un_long *hvals;   /* Hash values of the names */
+    int     *slots;   /* Argument position plus 1, or 0 if empty */
+    int      mask;    /* Table size minus 1 (the size is a power of 2) */
+    int      count;   /* Names in the table */
+    void  *(*afunc)(void *actx, size_t sz, int zero_flag);
+    void    *actx;    /* Context passed to afunc */
+} arg_index;
+
 /*
 ** String Functions
 */
@@ -862,6 +1033,8 @@ char *str_substr(const char *sptr, const char *ssub, int caseflag);
 
 char *str_dup(const char *sptr);
 
+un_long str_hash(const char *sptr, int maxlen, int caseflag);
+
 int   str_chrcmp(char *a, char *b, int caseflag);
 
 void  str_prepend(char *base_str, char *prefix_str);
@@ -882,8 +1055,25 @@ int   str_xtob(char *s, void *p);
 
 char *mem_find(char *mptr, long_64 mlen, const char *mpat, int plen);
 
+void  mem_pattern_init(mem_pattern *mp, const char *mpat, int plen);
+
+char *mem_scan(mem_pattern *mp, char *mptr, long_64 mlen);
+
 int   mem_compare(char *ptr1, int len1, char *ptr2, int len2);
 
+/*
+** Argument Index Functions
+*/
+int   argx_init(arg_index *ax, int n);
+
+int   argx_find(arg_index *ax, char **names, char *name, un_long h);
+
+int   argx_add(arg_index *ax, int pos, un_long h);
+
+int   argx_collect(arg_index *ax, int *nargs, file_arg *filelist,
+                   char **param_name, char **param_value,
+                   char ***param_array, arg_count *param_count);
+
 /*
 ** OS Functions
 */
@@ -956,6 +1146,8 @@ int         os_cond_signal(os_objptr mh);
 
 int         os_cond_destroy(os_objptr mh);
 
+int         os_atomic_add(volatile int *ptr, int delta);
+
 /*
 ** File I/O Functions
 */
@@ -974,6 +1166,8 @@ int         file_read_data(os_objhand fp, char *buffer, int buflen);
 
 void        file_close(os_objhand fp);
 
+os_objhand  file_dup(os_objhand fp);
+
 #ifndef NO_FILE_CACHE
 
 void       *os_virt_alloc(size_t sz);
@@ -982,6 +1176,8 @@ void        os_virt_free(void *ptr, size_t sz);
 
 os_objhand  file_open_read(char *fpath, un_long *fsz, un_long *fage);
 
+int         file_stat(char *fpath, un_long *fsz, un_long *ftime);
+
 os_objhand  file_map(os_objhand fp, un_long fsz,
                      char *mapname, int write_flag);
 
@@ -1051,6 +1247,19 @@ os_socket socket_accept(os_socket sock, char *buf, int bufsz);
 os_socket socket_connect(int port, char *ipaddr);
 
 int       socket_write(os_socket sock, char *buffer, int buflen);
+int       socket_writev(os_socket sock, char *buffer, int stride,
+                        un_short *lens, int nvec);
+long_64   socket_sendfile(os_socket sock, os_objhand fp,
+                          long_64 off, long_64 len);
+
+/*
+** Failure returns from socket_sendfile and morq_send_file.  Only
+** SEND_FILE_UNAVAILABLE means nothing was sent and the caller may
+** copy the file instead; after SEND_FILE_FAILED the response is
+** incomplete and must not be resent.
+*/
+#define SEND_FILE_UNAVAILABLE  ((long_64)-1)
+#define SEND_FILE_FAILED       ((long_64)-2)
 
 int       socket_read(os_socket sock, char *buffer, int buflen);
 
@@ -1162,6 +1371,12 @@ void  sql_get_version(int *major, int *minor);
 
 sword sql_parse(connection *c, OraCursor stmhp, char *stmt, int slen);
 
+sword sql_prepare(connection *c, OraCursor *pstmhp, char *stmt, int slen);
+
+sword sql_release(connection *c, int drop_flag);
+
+void  sql_spool_close(owa_context *octx);
+
 sword sql_fetch(connection *c, OraCursor stmhp, ub4 numrows);
 
 sword sql_exec(connection *c, OraCursor stmhp, ub4 niters, int exact);
@@ -1219,9 +1434,16 @@ sword sql_bind_stream(connection *c, OraCursor stmhp, ub4 pos, ub2 sql_type);
 sword sql_bind_ptrs(connection *c, OraCursor stmhp, ub4 pos,
                     char **aptr, sb4 awidth, ub4 *asize, ub4 amax);
 
+sword sql_bind_strs(connection *c, OraCursor stmhp, ub4 pos,
+                    char **aptr, sb4 awidth, ub4 *asize, ub4 amax);
+
 sword sql_bind_lob(connection *c, OraCursor stmhp, ub4 pos, ub2 flag);
 
-sword sql_define_lob(connection *c, OraCursor stmhp, ub4 pos, ub2 flag);
+sword sql_define_lob(connection *c, OraCursor stmhp, ub4 pos, ub2 flag,
+                     ub4 prefetch);
+
+sword sql_define_lobarr(connection *c, OraCursor stmhp, ub4 pos,
+                        OCILobLocator **locs, sb2 *inds, ub4 prefetch);
 
 sword sql_get_rowcount(connection *c, OraCursor stmhp, ub4 *rowcount);
 
@@ -1241,6 +1463,9 @@ sword sql_read_piece(connection *c, OraCursor stmhp,
 int   sql_describe(connection *c, char *pname, int descmode, char *schema,
                    int nargs, char *names[], ub4 counts[]);
 
+int   sql_describe_tables(connection *c, char *pname,
+                          char *names, int maxlen);
+
 #endif
 
 /*
@@ -1255,10 +1480,18 @@ void  mowa_release_mutex(owa_context *octx);
 
 void  mowa_semaphore_create(owa_context *octx);
 
-int   mowa_semaphore_get(owa_context *octx);
+int   mowa_semaphore_get(owa_context *octx, int wait_ms);
 
 void  mowa_semaphore_put(owa_context *octx);
 
+int   mowa_queue_wait(owa_context *octx, int ticket, int wait_ms);
+
+void  mowa_queue_wake(owa_context *octx, int ticket);
+
+int   mowa_reset_async(owa_context *octx);
+
+void  mowa_thread_wake(owa_context *octx);
+
 /*
 ** Apache-based request-related functions
 */
@@ -1294,6 +1527,12 @@ long  morq_read(request_rec *request, char *buffer, long buflen);
 
 long  morq_write(request_rec *request, char *buffer, long buflen);
 
+long  morq_writev(request_rec *request, char *buffer, int stride,
+                  un_short *lens, int nvec);
+
+long_64 morq_send_file(request_rec *request, char *fpath, os_objhand fp,
+                       long_64 off, long_64 len);
+
 void  morq_print_int(request_rec *request, char *fmt, long ival);
 
 void  morq_print_str(request_rec *request, char *fmt, char *sptr);
@@ -1327,6 +1566,8 @@ void  morq_sql_error(request_rec *request,
 int   owa_handle_request(owa_context *octx, request_rec *r,
                          char *req_args, int req_method, owa_request *owa_req);
 
+void  owa_free_args(owa_request *owa_req);
+
 int   owa_dav_request(owa_context *octx, request_rec *r,
                       char *req_args, char *req_uri, int req_method);
 
@@ -1346,6 +1587,12 @@ int   owa_readlong(connection *c, owa_context *octx, request_rec *r,
 int   owa_rlobtable(connection *c, owa_context *octx, request_rec *r,
                     char *name, char *pmimetype, char *pcdisp, char *outbuf);
 
+int   owa_rlobcache(owa_context *octx, request_rec *r, char *user,
+                    char *name, char *pmimetype, char *pcdisp);
+
+int   owa_rlobbatch(connection *c, owa_context *octx, request_rec *r,
+                    char *user, char *names, char *outbuf);
+
 int   owa_wlobtable(connection *c, owa_context *octx, request_rec *r,
                     char *outbuf, file_arg *filelist,
                     char **vals, char **valptrs, char *marker);
@@ -1374,7 +1621,8 @@ owa_log_socks *owa_log_free(owa_log_socks *s);
 int   owa_runplsql(connection *c, char *stmt, char *outbuf, int xargs,
                    int nargs, char *values[], ub4 counts[], sb4 widths[],
                    char **pointers, ub2 *plens, un_long arr_round, int csid,
-                   int zero_flag);
+                   int zero_flag, owa_context *octx, env_record *penv,
+                   owa_request *owa_req);
 
 int   owa_showerror(connection *c, char *stmt, int errcode);
 
@@ -1386,6 +1634,38 @@ char *owa_map_cache(owa_context *octx, request_rec *r,
 int   owa_download_file(owa_context *octx, request_rec *r,
                         char *fpath, char *pmimetype, ub4 life, char *outbuf);
 
+int   owa_shmem_desc_gen(shm_context *map);
+
+int   owa_shmem_desc_clears(shm_context *map);
+
+void  owa_shmem_desc_put(shm_context *map, char *location, char *pname,
+                         char *data, int dlen);
+
+void  owa_shmem_desc_load(shm_context *map, owa_context *octx,
+                          void (*loadfn)(owa_context *octx, char *pname,
+                                         char *data, int dlen));
+
+void  owa_shmem_desc_clear(shm_context *map, char *location);
+
+void  owa_shmem_purge(shm_context *map, char *prefix,
+                      un_long life, un_long interval);
+
+long  owa_shmem_get(shm_context *map, request_rec *r, char *key,
+                    un_long life, char *ctype, char **pdata);
+
+void  owa_shmem_put(shm_context *map, char *key, char *ctype,
+                    char *data, long dlen, un_long ctime);
+
+long  owa_shmem_doc_get(shm_context *map, request_rec *r, char *location,
+                        char *user, char *name, un_long life,
+                        char *ctype, char **pdata);
+
+void  owa_shmem_doc_put(shm_context *map, char *location, char *user,
+                        char *name, char *ctype, char *data, long dlen);
+
+int   owa_shmem_doc_check(shm_context *map, char *location, char *user,
+                          char *name, un_long life);
+
 int   owa_create_path(char *fpath, char *tempbuf);
 
 #endif
@@ -1401,6 +1681,9 @@ int   owa_reset(connection *c, owa_context *octx);
 int   owa_passenv(connection *c, owa_context *octx,
                   env_record *penv, owa_request *owa_req);
 
+int   owa_fuse_statement(owa_context *octx, char *stmt,
+                         char *outstmt, int olen);
+
 void  owa_set_statements(owa_context *octx);
 
 void  owa_out_args(char *argarr[], int mode_flag);
@@ -1409,6 +1692,20 @@ void  owa_cleanup(owa_context *octx);
 
 void  owa_pool_purge(owa_context *octx, int interval);
 
+void  owa_pool_reset(owa_context *octx);
+
+void  owa_pool_warm(owa_context *octx);
+
+void  owa_desc_preload(owa_context *octx);
+
+void  owa_pool_init(owa_context *octx);
+
+void  owa_pool_link(owa_context *octx, connection *c);
+
+void  owa_pool_unlink(owa_context *octx, connection *c);
+
+connection *owa_pool_match(owa_context *octx, char *session);
+
 #ifndef NO_FILE_CACHE
 
 void  owa_file_purge(owa_context *octx, int interval);
@@ -1424,6 +1721,9 @@ un_long owa_shmem_init(shm_context *map);
 void    owa_shmem_update(shm_context *map, int *mapoff, int realpid,
                          char *location, int *poolstats);
 
-int     owa_shmem_stats(shm_context *map, char *location, int *poolstats);
+int     owa_shmem_stats(shm_context *map, char *location, int *poolstats,
+                        int *qstats);
+
+void    owa_shmem_queue(shm_context *map, int mapoff, int *qstats);
 
 #endif /* MODOWA_H */
@@ -58,6 +58,20 @@
 ** 11/27/2012   D. McMahon      GCC fixes, Win-64 porting
 ** 09/19/2013   D. McMahon      64-bit content lengths
 ** 05/07/2015   D. McMahon      Make morq_get_range use 64-bit ints
+** 10/17/2026   D. McMahon      Per-state pool lists and session hash
+** 10/17/2026   D. McMahon      Add shared memory page cache
+** 10/17/2026   D. McMahon      Add per-process mapped file cache
+** 10/17/2026   D. McMahon      Send uncached file downloads with sendfile
+** 10/17/2026   D. McMahon      Share describe results through shared memory
+** 10/17/2026   D. McMahon      Add pool list for slots awaiting a reset
+** 10/17/2026   D. McMahon      Keep the warm floor when trimming the pool
+** 10/17/2026   D. McMahon      Add admission queue statistics to pool records
+** 10/17/2026   D. McMahon      Add prefetched document entries to page cache
+** 10/17/2026   D. McMahon      Purge shared memory pages on CLEARCACHE!
+** 10/17/2026   D. McMahon      Don't resend a file after a failed sendfile
+** 10/17/2026   D. McMahon      Count describe cache clears
+** 10/17/2026   D. McMahon      Key prefetched documents by user
+** 10/17/2026   D. McMahon      Bump describe generation under the semaphore
 */
 
 #define WITH_OCI
@@ -74,8 +88,84 @@ typedef struct pool_record
     int pid;                       /* Process ID */
     int location;                  /* Offset to location name string */
     ub1 poolstats[C_LOCK_MAXIMUM]; /* ### 0-255, NOT QUITE 256 ### */
+    int qstats[QSTAT_SIZE];        /* Admission queue depth, sheds, waits */
 } pool_record;
 
+#ifndef NO_FILE_CACHE
+/*
+** Shared memory page cache.  The part of the segment after the pool
+** statistics and location name pages holds a header followed by an
+** arena of slabs.  Slab sizes are powers of two from SHM_SLAB_MIN up;
+** freed slabs go on a free list for their size class.  Cached pages
+** are found through a hash table of chains.  Everything is addressed
+** by offset from the start of the header (0 means "none"), since the
+** segment may be attached at different addresses in different
+** processes.  All access is made under the segment semaphore.
+*/
+#define SHM_HASH_SIZE     1024
+#define SHM_SLAB_MIN      1024
+#define SHM_SLAB_CLASSES  24
+
+typedef struct shm_cache
+{
+    un_long  arena;                       /* Size of the cache area    */
+    un_long  brk;                         /* First uncarved offset     */
+    un_long  sweep;                       /* Eviction cursor (bucket)  */
+    un_long  hits;
+    un_long  misses;
+    un_long  stores;
+    un_long  evicts;
+    int      desc_gen;                    /* Describe publish count    */
+    int      desc_clears;                 /* Describe clear count      */
+    un_long  buckets[SHM_HASH_SIZE];      /* Hash chains               */
+    un_long  freelist[SHM_SLAB_CLASSES];  /* Free slabs by size class  */
+} shm_cache;
+
+typedef struct shm_entry
+{
+    un_long  next;                        /* Hash chain or free list   */
+    un_long  hashval;
+    un_long  ctime;                       /* Time content was created  */
+    int      sclass;                      /* Slab size class           */
+    int      keylen;                      /* Lengths include the null  */
+    int      typelen;
+    int      datalen;
+} shm_entry;
+
+#define SHM_ENTRY(cache, off) ((shm_entry *)((char *)(cache) + (off)))
+
+static void owa_shmem_cache_show(shm_context *map, request_rec *r);
+
+/*
+** Per-process cache of memory-mapped files.  Hot cached pages keep a
+** read-only mapping open between requests, so that a hit costs one
+** stat() to validate the size and modification time rather than an
+** open, map, unmap, and close.  Entries in use by a request are
+** pinned with a reference count; an entry found to be out of date
+** while pinned is marked stale and unmapped by the last user.
+*/
+#define FMAP_CACHE_SIZE  32
+
+typedef struct fmap_entry
+{
+    char       *fpath;
+    un_long     hashval;
+    os_objhand  hnd;
+    void       *ptr;
+    un_long     fsz;
+    un_long     ftime;
+    un_long     lastuse;
+    int         refs;
+    int         stale;
+} fmap_entry;
+
+typedef struct fmap_cache
+{
+    un_long     clock;
+    fmap_entry  ents[FMAP_CACHE_SIZE];
+} fmap_cache;
+#endif
+
 #ifndef NO_FILE_CACHE
 /*
 ** Search the alias table for a key/value pair that matches the path.
@@ -212,7 +302,164 @@ void owa_file_purge(owa_context *octx, int interval)
             str_concat(fpath, 0, octx->lifes[i].physname, sizeof(fpath) - 1);
             purge_directory(fpath, life, curtime, interval);
         }
+        /*
+        ** Pages copied into shared memory have to go as well, or
+        ** they'd keep being served after their files were deleted
+        ** (indefinitely for a lifespan of 0).
+        */
+        owa_shmem_purge(octx->mapmem, octx->lifes[i].physname,
+                        life, (un_long)interval);
     }
+    if ((interval == 0) && (octx->doc_file))
+        owa_shmem_purge(octx->mapmem, octx->doc_file, (un_long)0, (un_long)0);
+}
+
+/*
+** Unmap a cached file and empty its slot
+*/
+static void owa_fmap_drop(fmap_entry *fent)
+{
+    file_unmap(fent->hnd, fent->ptr, fent->fsz);
+    mem_free((void *)(fent->fpath));
+    fent->fpath = (char *)0;
+    fent->ptr = (void *)0;
+    fent->hnd = os_nullfilehand;
+    fent->stale = 0;
+}
+
+/*
+** Find a file in the mapped file cache, adding it if necessary.
+** Returns a pinned entry, or null if the file isn't present, is
+** older than life seconds, or can't be cached.
+*/
+static fmap_entry *owa_fmap_get(owa_context *octx, char *fpath,
+                                ub4 life, un_long *fage)
+{
+    fmap_cache *fc;
+    fmap_entry *fent;
+    fmap_entry *victim;
+    un_long     fsz, ftime;
+    un_long     h;
+    os_objhand  fp;
+    os_objhand  hnd;
+    void       *ptr;
+    int         i;
+
+    if (!(octx->fmaps))
+    {
+        mowa_acquire_mutex(octx);
+        if (!(octx->fmaps))
+        {
+            fc = (fmap_cache *)mem_zalloc(sizeof(*fc));
+            if (fc)
+                for (i = 0; i < FMAP_CACHE_SIZE; ++i)
+                    fc->ents[i].hnd = os_nullfilehand;
+            octx->fmaps = (void *)fc;
+        }
+        mowa_release_mutex(octx);
+    }
+    fc = (fmap_cache *)(octx->fmaps);
+    if (!fc) return((fmap_entry *)0);
+
+    h = str_hash(fpath, -1, 0);
+    fent = (fmap_entry *)0;
+
+    if (file_stat(fpath, &fsz, &ftime) == 0)
+    {
+        *fage = os_get_time((un_long *)0) - ftime;
+        if ((life != (ub4)0) && (*fage > life)) fsz = 0;
+    }
+    else
+        fsz = 0;
+
+    mowa_acquire_mutex(octx);
+    for (i = 0; i < FMAP_CACHE_SIZE; ++i)
+    {
+        fent = fc->ents + i;
+        if ((fent->fpath) && (!fent->stale) && (fent->hashval == h))
+            if (!str_compare(fent->fpath, fpath, -1, 0))
+                break;
+    }
+    if (i == FMAP_CACHE_SIZE)
+        fent = (fmap_entry *)0;
+    else if ((fent->fsz != fsz) || (fent->ftime != ftime))
+    {
+        /* File has changed or gone away */
+        if (fent->refs == 0) owa_fmap_drop(fent);
+        else                 fent->stale = 1;
+        fent = (fmap_entry *)0;
+    }
+    else
+    {
+        ++(fent->refs);
+        fent->lastuse = ++(fc->clock);
+    }
+    mowa_release_mutex(octx);
+
+    if ((fent) || (fsz == 0) || (fsz > (un_long)CACHE_MAX_SIZE))
+        return(fent);
+
+    /*
+    ** Map the file outside the mutex.  The file handle isn't needed
+    ** once the mapping exists.
+    */
+    fp = file_open_read(fpath, &fsz, fage);
+    if (InvalidFile(fp)) return((fmap_entry *)0);
+    hnd = file_map(fp, fsz, (char *)0, 0);
+    ptr = file_view(hnd, fsz, 0);
+    file_close(fp);
+    if (!ptr)
+    {
+        file_unmap(hnd, ptr, fsz);
+        return((fmap_entry *)0);
+    }
+
+    /* Take an empty slot, or else the least-recently-used idle one */
+    mowa_acquire_mutex(octx);
+    victim = (fmap_entry *)0;
+    for (i = 0; i < FMAP_CACHE_SIZE; ++i)
+    {
+        fent = fc->ents + i;
+        if (!(fent->fpath))
+        {
+            victim = fent;
+            break;
+        }
+        if ((fent->refs == 0) &&
+            ((!victim) || (fent->lastuse < victim->lastuse)))
+            victim = fent;
+    }
+    fent = victim;
+    if (fent)
+    {
+        if (fent->fpath) owa_fmap_drop(fent);
+        fent->fpath = str_dup(fpath);
+        if (!(fent->fpath)) fent = (fmap_entry *)0;
+    }
+    if (fent)
+    {
+        fent->hashval = h;
+        fent->hnd = hnd;
+        fent->ptr = ptr;
+        fent->fsz = fsz;
+        fent->ftime = ftime;
+        fent->refs = 1;
+        fent->lastuse = ++(fc->clock);
+    }
+    mowa_release_mutex(octx);
+
+    if (!fent) file_unmap(hnd, ptr, fsz);
+    return(fent);
+}
+
+/*
+** Unpin a mapped file cache entry
+*/
+static void owa_fmap_release(owa_context *octx, fmap_entry *fent)
+{
+    mowa_acquire_mutex(octx);
+    if ((--(fent->refs) == 0) && (fent->stale)) owa_fmap_drop(fent);
+    mowa_release_mutex(octx);
 }
 
 /*
@@ -229,17 +476,44 @@ int owa_download_file(owa_context *octx, request_rec *r,
     int         status = 0;
     os_objhand  hnd = os_nullfilehand;
     void       *ptr = (void *)0;
+    char       *mptr = (char *)0;
+    long        mlen;
+    fmap_entry *fent = (fmap_entry *)0;
     int         range_flag = 0;
     long_64     range_offset;
     long_64     range_length;
+    long_64     sent;
 
-    fp = file_open_read(fpath, &clen, &fage);
-    if (InvalidFile(fp)) goto down_err;
-    if ((life != (ub4)0) && (fage > life)) goto down_err;
-    if (clen <= (un_long)CACHE_MAX_SIZE)
+    /*
+    ** Try the shared memory cache first; if the page is there, no
+    ** file system access is needed at all.
+    */
+    fp = os_nullfilehand;
+    mlen = owa_shmem_get(octx->mapmem, r, fpath, life, pmimetype, &mptr);
+    if (mlen >= 0)
+    {
+        clen = (un_long)mlen;
+        ptr = (void *)mptr;
+    }
+    else if ((fent = owa_fmap_get(octx, fpath, life, &fage)))
     {
-        hnd = file_map(fp, clen, (char *)0, 0);
-        ptr = file_view(hnd, clen, 0);
+        clen = fent->fsz;
+        ptr = fent->ptr;
+    }
+    else
+    {
+        /*
+        ** Map the file only if it can go into the shared memory cache;
+        ** otherwise it will be sent straight from the file.
+        */
+        fp = file_open_read(fpath, &clen, &fage);
+        if (InvalidFile(fp)) goto down_err;
+        if ((life != (ub4)0) && (fage > life)) goto down_err;
+        if ((octx->mapmem) && (clen <= (un_long)(octx->mapmem->memthresh)))
+        {
+            hnd = file_map(fp, clen, (char *)0, 0);
+            ptr = file_view(hnd, clen, 0);
+        }
     }
 
     /*
@@ -248,6 +522,15 @@ int owa_download_file(owa_context *octx, request_rec *r,
     */
     if (*pmimetype == '\0') util_set_mime(fpath, pmimetype, 1);
 
+    /*
+    ** Copy small mapped files into the shared memory cache, keeping
+    ** the file's age so that it expires on the same schedule.
+    */
+    if ((ptr) && (!mptr) && (octx->mapmem))
+        if (clen <= (un_long)(octx->mapmem->memthresh))
+            owa_shmem_put(octx->mapmem, fpath, pmimetype, (char *)ptr,
+                          (long)clen, os_get_time((un_long *)0) - fage);
+
     /*
     ** Add the character set to the Content-Type
     ** ### SHOULD THIS BE OMITTED FOR BINARY DONWLOADS? ###
@@ -288,7 +571,10 @@ int owa_download_file(owa_context *octx, request_rec *r,
             /* ### Range length limited to 2G ### */
             if (ptr)
                 morq_write(r, (char *)ptr + range_offset, (long)range_length);
-            else
+            else if ((sent = morq_send_file(r, fpath, fp, range_offset,
+                                            range_length)) == SEND_FILE_FAILED)
+                goto send_err;
+            else if (sent == SEND_FILE_UNAVAILABLE)
             {
                 file_seek(fp, (long)range_offset);
                 for (ctot = (un_long)range_length; ctot > 0; ctot -= nbytes)
@@ -316,10 +602,15 @@ int owa_download_file(owa_context *octx, request_rec *r,
     else if (ptr)
         morq_write(r, (char *)ptr, (long)clen);
     /*
-    ** Transfer the file contents using a series of buffered reads
+    ** Transfer the file contents using sendfile if possible,
+    ** or else using a series of buffered reads
     */
-    else
+    else if ((sent = morq_send_file(r, fpath, fp, (long_64)0,
+                                    (long_64)clen)) == SEND_FILE_FAILED)
+        goto send_err;
+    else if (sent == SEND_FILE_UNAVAILABLE)
     {
+        file_seek(fp, 0L);
         for (ctot = clen; ctot > 0; ctot -= nbytes)
         {
             nbytes = HTBUF_BLOCK_READ;
@@ -335,10 +626,18 @@ int owa_download_file(owa_context *octx, request_rec *r,
                   "Transferred %d bytes from cached file [%s]\n",
                   fpath, (char *)0, clen, 0);
 
+send_err:
+    /*
+    ** Once any content has gone out the request is finished, even if
+    ** the transfer failed partway; the caller mustn't send it again.
+    */
     status = 1;
 
 down_err:
-    file_unmap(hnd, ptr, clen);
+    if (fent)
+        owa_fmap_release(octx, fent);
+    else if (!mptr)
+        file_unmap(hnd, ptr, clen);
     file_close(fp);
     return(status);
 }
@@ -417,9 +716,127 @@ void owa_file_show(owa_context *octx, request_rec *r)
         }
     }
     morq_write(r, "</table>\n", -1);
+    owa_shmem_cache_show(octx->mapmem, r);
 #endif
 }
 
+#ifndef NO_FILE_CACHE
+/*
+** Lay out the page cache header in a newly-created segment
+*/
+static void owa_shmem_cache_init(shm_context *map, un_long sz)
+{
+    shm_cache *cache;
+    un_long    hsz;
+    int        i;
+
+    cache = (shm_cache *)((char *)(map->map_ptr) + (map->pagesize << 1));
+    hsz = (un_long)((sizeof(shm_cache) + 7) & ~7);
+    cache->arena = sz - (un_long)(map->pagesize << 1);
+    if (cache->arena < hsz + (un_long)SHM_SLAB_MIN) cache->arena = 0;
+    cache->brk = hsz;
+    cache->sweep = 0;
+    cache->hits = cache->misses = cache->stores = cache->evicts = 0;
+    cache->desc_gen = 0;
+    cache->desc_clears = 0;
+    for (i = 0; i < SHM_HASH_SIZE; ++i) cache->buckets[i] = 0;
+    for (i = 0; i < SHM_SLAB_CLASSES; ++i) cache->freelist[i] = 0;
+}
+
+/*
+** Return the page cache header, or null if there's no usable cache
+*/
+static shm_cache *owa_shmem_cache(shm_context *map)
+{
+    shm_cache *cache;
+
+    if (!map) return((shm_cache *)0);
+    if ((!(map->map_ptr)) || (map->memthresh == 0)) return((shm_cache *)0);
+    cache = (shm_cache *)((char *)(map->map_ptr) + (map->pagesize << 1));
+    if (cache->arena == 0) return((shm_cache *)0);
+    return(cache);
+}
+
+/*
+** Unlink the entry at offset off from its hash chain and free its slab
+*/
+static void owa_shmem_cache_free(shm_cache *cache, un_long off)
+{
+    shm_entry *ent = SHM_ENTRY(cache, off);
+    un_long   *pnext;
+
+    pnext = &(cache->buckets[ent->hashval % SHM_HASH_SIZE]);
+    while (*pnext)
+    {
+        if (*pnext == off)
+        {
+            *pnext = ent->next;
+            break;
+        }
+        pnext = &(SHM_ENTRY(cache, *pnext)->next);
+    }
+    ent->next = cache->freelist[ent->sclass];
+    cache->freelist[ent->sclass] = off;
+}
+
+/*
+** Get a slab of the given size class, carving a new one from the
+** arena if none are free, or else evicting a page of the same class.
+** The eviction cursor sweeps around the hash table so that victims
+** are spread evenly.
+*/
+static un_long owa_shmem_cache_alloc(shm_cache *cache, int sclass)
+{
+    un_long off;
+    un_long ssz = ((un_long)SHM_SLAB_MIN << sclass);
+    int     i;
+
+    if (!cache->freelist[sclass])
+    {
+        if ((cache->arena - cache->brk) >= ssz)
+        {
+            off = cache->brk;
+            cache->brk += ssz;
+            return(off);
+        }
+        for (i = 0; i < SHM_HASH_SIZE; ++i)
+        {
+            off = cache->buckets[cache->sweep];
+            cache->sweep = (cache->sweep + 1) % SHM_HASH_SIZE;
+            while ((off) && (SHM_ENTRY(cache, off)->sclass != sclass))
+                off = SHM_ENTRY(cache, off)->next;
+            if (off)
+            {
+                owa_shmem_cache_free(cache, off);
+                ++(cache->evicts);
+                break;
+            }
+        }
+    }
+    off = cache->freelist[sclass];
+    if (off) cache->freelist[sclass] = SHM_ENTRY(cache, off)->next;
+    return(off);
+}
+
+/*
+** Search a hash chain for the entry matching a key
+*/
+static un_long owa_shmem_cache_find(shm_cache *cache, char *key, un_long h)
+{
+    un_long    off;
+    shm_entry *ent;
+
+    for (off = cache->buckets[h % SHM_HASH_SIZE]; off; off = ent->next)
+    {
+        ent = SHM_ENTRY(cache, off);
+        if (ent->hashval == h)
+            if (!str_compare(key, (char *)(ent + 1), -1, 0))
+                break;
+    }
+    return(off);
+}
+#endif
+
 /*
 ** Initialize shared memory segment
 */
@@ -458,6 +875,7 @@ un_long owa_shmem_init(shm_context *map)
                     prec->pid = 0;
                     prec->location = -1;
                     ((char *)(map->map_ptr))[map->pagesize] = '\0';
+                    owa_shmem_cache_init(map, sz);
 #ifndef NO_MARK_FOR_DESTRUCT
                     /* Mark memory for destruction when last process exits */
                     os_shm_destroy(hnd);
@@ -611,6 +1029,8 @@ void owa_shmem_update(shm_context *map, int *mapoff, int realpid,
                   prec->location = locidx;
                   for (i = 0; i < C_LOCK_MAXIMUM; ++i)
                       prec->poolstats[i] = (ub1)(poolstats[i] & 0xFF);
+                  for (i = 0; i < QSTAT_SIZE; ++i)
+                      prec->qstats[i] = 0;
                   if (++recnum < maxrecs)
                   {
                       prec[1].pid = 0;
@@ -624,9 +1044,31 @@ void owa_shmem_update(shm_context *map, int *mapoff, int realpid,
 }
 
 /*
-** Read and summarize pool statistics
+** Update the admission queue statistics in this process's pool record
+*/
+void owa_shmem_queue(shm_context *map, int mapoff, int *qstats)
+{
+#ifdef KEEP_GLOBAL_STATS
+    volatile pool_record *prec;
+    int                   i;
+
+    if (mapoff < 0) return;
+    if (map)
+      if (map->map_ptr)
+      {
+          prec = (pool_record *)(map->map_ptr) + mapoff;
+          for (i = 0; i < QSTAT_SIZE; ++i)
+              prec->qstats[i] = qstats[i];
+      }
+#endif
+}
+
+/*
+** Read and summarize pool statistics (and admission queue statistics,
+** if qstats isn't null)
 */
-int owa_shmem_stats(shm_context *map, char *location, int *poolstats)
+int owa_shmem_stats(shm_context *map, char *location, int *poolstats,
+                    int *qstats)
 {
 #ifdef KEEP_GLOBAL_STATS
     pool_record *prec;
@@ -640,6 +1082,8 @@ int owa_shmem_stats(shm_context *map, char *location, int *poolstats)
       if (map->map_ptr)
       {
           for (i = 0; i < C_LOCK_MAXIMUM; ++i) poolstats[i] = 0;
+          if (qstats)
+            for (i = 0; i < QSTAT_SIZE; ++i) qstats[i] = 0;
 
           prec = (pool_record *)(map->map_ptr);
           lname = (char *)(map->map_ptr) + map->pagesize;
@@ -658,6 +1102,9 @@ int owa_shmem_stats(shm_context *map, char *location, int *poolstats)
                 {
                   for (i = 0; i < C_LOCK_MAXIMUM; ++i)
                       poolstats[i] += (prec->poolstats[i] & 0xFF);
+                  if (qstats)
+                    for (i = 0; i < QSTAT_SIZE; ++i)
+                      qstats[i] += prec->qstats[i];
                   ++nrecs;
                 }
               }
@@ -670,15 +1117,600 @@ int owa_shmem_stats(shm_context *map, char *location, int *poolstats)
     return(-1);
 }
 
+#ifndef NO_FILE_CACHE
+/*
+** Look up a page in the shared memory cache.  If it's present and
+** no older than life seconds (0 means no limit), the content is copied
+** to memory from the request pool and its length returned; otherwise
+** returns -1.  If the caller's content type is empty, it's filled in
+** from the cached one.
+*/
+long owa_shmem_get(shm_context *map, request_rec *r, char *key,
+                   un_long life, char *ctype, char **pdata)
+{
+    shm_cache *cache;
+    shm_entry *ent;
+    un_long    off;
+    un_long    h;
+    long       dlen = -1;
+    char      *sptr;
+
+    cache = owa_shmem_cache(map);
+    if (!cache) return(-1);
+
+    h = str_hash(key, -1, 0);
+    if (!os_sem_acquire(map->f_mutex, SHMEM_WAIT_MAX)) return(-1);
+    off = owa_shmem_cache_find(cache, key, h);
+    if (off)
+    {
+        ent = SHM_ENTRY(cache, off);
+        if ((life != 0) &&
+            ((os_get_time((un_long *)0) - ent->ctime) > life))
+        {
+            /* Expired, discard it */
+            owa_shmem_cache_free(cache, off);
+        }
+        else
+        {
+            *pdata = (char *)morq_alloc(r, (size_t)(ent->datalen + 1), 0);
+            if (*pdata)
+            {
+                sptr = (char *)(ent + 1) + ent->keylen;
+                if (*ctype == '\0') str_copy(ctype, sptr);
+                sptr += ent->typelen;
+                dlen = (long)(ent->datalen);
+                mem_copy(*pdata, sptr, (int)dlen);
+                (*pdata)[dlen] = '\0';
+            }
+        }
+    }
+    if (dlen >= 0) ++(cache->hits);
+    else           ++(cache->misses);
+    os_sem_release(map->f_mutex);
+
+    return(dlen);
+}
+
+/*
+** Store a page in the shared memory cache, replacing any older copy.
+** Pages larger than the memory threshold aren't cached.
+*/
+void owa_shmem_put(shm_context *map, char *key, char *ctype,
+                   char *data, long dlen, un_long ctime)
+{
+    shm_cache *cache;
+    shm_entry *ent;
+    un_long    off;
+    un_long    h;
+    un_long    esz;
+    int        klen, tlen;
+    int        sclass;
+    char      *sptr;
+
+    cache = owa_shmem_cache(map);
+    if ((!cache) || (dlen < 0) || ((size_t)dlen > map->memthresh)) return;
+
+    if (!ctype) ctype = "";
+    klen = str_length(key) + 1;
+    tlen = str_length(ctype) + 1;
+    if (tlen > HTBUF_LINE_LENGTH) return;
+    esz = (un_long)(sizeof(shm_entry) + klen + tlen) + (un_long)dlen;
+    for (sclass = 0; sclass < SHM_SLAB_CLASSES; ++sclass)
+        if (((un_long)SHM_SLAB_MIN << sclass) >= esz) break;
+    if (sclass == SHM_SLAB_CLASSES) return;
+
+    h = str_hash(key, -1, 0);
+    if (!os_sem_acquire(map->f_mutex, SHMEM_WAIT_MAX)) return;
+    off = owa_shmem_cache_find(cache, key, h);
+    if (off) owa_shmem_cache_free(cache, off);
+    off = owa_shmem_cache_alloc(cache, sclass);
+    if (off)
+    {
+        ent = SHM_ENTRY(cache, off);
+        ent->hashval = h;
+        ent->ctime = ctime;
+        ent->sclass = sclass;
+        ent->keylen = klen;
+        ent->typelen = tlen;
+        ent->datalen = (int)dlen;
+        sptr = (char *)(ent + 1);
+        mem_copy(sptr, key, klen);
+        sptr += klen;
+        mem_copy(sptr, ctype, tlen);
+        sptr += tlen;
+        mem_copy(sptr, data, (int)dlen);
+        ent->next = cache->buckets[h % SHM_HASH_SIZE];
+        cache->buckets[h % SHM_HASH_SIZE] = off;
+        ++(cache->stores);
+    }
+    os_sem_release(map->f_mutex);
+}
+
+/*
+** Documents prefetched from a location's document table are kept in
+** the page cache under keys that can't collide with file paths:
+**   \001T<location>\001<document name>\001<database user>
+** The user is part of the key because with OwaRealm each user has a
+** session of their own, and what the table returns may depend on it;
+** it's empty for locations that always connect as the same user.
+** Entries expire after the life set by OwaDocLobs CACHE, since the
+** table may be updated without mod_owa knowing.
+*/
+static int owa_shmem_doc_key(char *key, int keymax,
+                             char *location, char *name, char *user)
+{
+    int i;
+
+    if (!user) user = "";
+    if ((str_length(location) + str_length(name) + str_length(user) + 4)
+        >= keymax)
+        return(0);
+    i = str_concat(key, 0, "\001T", keymax);
+    i = str_concat(key, i, location, keymax);
+    i = str_concat(key, i, "\001", keymax);
+    i = str_concat(key, i, name, keymax);
+    i = str_concat(key, i, "\001", keymax);
+    return(str_concat(key, i, user, keymax));
+}
+
+/*
+** Look up a prefetched document; see owa_shmem_get
+*/
+long owa_shmem_doc_get(shm_context *map, request_rec *r, char *location,
+                       char *user, char *name, un_long life,
+                       char *ctype, char **pdata)
+{
+    char key[HTBUF_HEADER_MAX];
+
+    if (!owa_shmem_doc_key(key, sizeof(key) - 1, location, name, user))
+        return(-1);
+    return(owa_shmem_get(map, r, key, life, ctype, pdata));
+}
+
+/*
+** Store a prefetched document
+*/
+void owa_shmem_doc_put(shm_context *map, char *location, char *user,
+                       char *name, char *ctype, char *data, long dlen)
+{
+    char key[HTBUF_HEADER_MAX];
+
+    if (!owa_shmem_doc_key(key, sizeof(key) - 1, location, name, user))
+        return;
+    owa_shmem_put(map, key, ctype, data, dlen, os_get_time((un_long *)0));
+}
+
+/*
+** Check whether a prefetched document is cached and still fresh,
+** without copying it out
+*/
+int owa_shmem_doc_check(shm_context *map, char *location, char *user,
+                        char *name, un_long life)
+{
+    shm_cache *cache;
+    shm_entry *ent;
+    un_long    off;
+    int        found = 0;
+    char       key[HTBUF_HEADER_MAX];
+
+    cache = owa_shmem_cache(map);
+    if (!cache) return(0);
+    if (!owa_shmem_doc_key(key, sizeof(key) - 1, location, name, user))
+        return(0);
+
+    if (!os_sem_acquire(map->f_mutex, SHMEM_WAIT_MAX)) return(0);
+    off = owa_shmem_cache_find(cache, key, str_hash(key, -1, 0));
+    if (off)
+    {
+        ent = SHM_ENTRY(cache, off);
+        found = ((os_get_time((un_long *)0) - ent->ctime) <= life);
+    }
+    os_sem_release(map->f_mutex);
+
+    return(found);
+}
+
+/*
+** Describe results are shared between processes through the page
+** cache, using keys that can't collide with file paths:
+**   \001D<location>\001<lower-case procedure name>
+** Every publication bumps a generation count, which processes can
+** check cheaply (without the semaphore) to see if there's anything
+** new to load.
+*/
+static int owa_shmem_desc_key(char *key, int keymax,
+                              char *location, char *pname)
+{
+    int i, j;
+
+    i = str_concat(key, 0, "\001D", keymax);
+    i = str_concat(key, i, location, keymax);
+    i = str_concat(key, i, "\001", keymax);
+    j = str_concat(key, i, pname, keymax);
+    for (; i < j; ++i)
+        if ((key[i] >= 'A') && (key[i] <= 'Z')) key[i] += ('a' - 'A');
+    return(j);
+}
+
+/*
+** Return the describe generation count, or -1 if there's no cache
+*/
+int owa_shmem_desc_gen(shm_context *map)
+{
+    volatile shm_cache *cache;
+
+    cache = owa_shmem_cache(map);
+    if (!cache) return(-1);
+    return(cache->desc_gen);
+}
+
+/*
+** Return the count of describe cache clears, or -1 if there's no cache.
+** A clear also bumps the generation count, so this only needs to be
+** checked after the generation has changed.
+*/
+int owa_shmem_desc_clears(shm_context *map)
+{
+    volatile shm_cache *cache;
+
+    cache = owa_shmem_cache(map);
+    if (!cache) return(-1);
+    return(cache->desc_clears);
+}
+
+/*
+** Publish a describe result for a location
+*/
+void owa_shmem_desc_put(shm_context *map, char *location, char *pname,
+                        char *data, int dlen)
+{
+    shm_cache *cache;
+    char       key[HTBUF_HEADER_MAX];
+
+    cache = owa_shmem_cache(map);
+    if (!cache) return;
+    if ((str_length(location) + str_length(pname) + 3) >= sizeof(key))
+        return;
+    owa_shmem_desc_key(key, sizeof(key) - 1, location, pname);
+    owa_shmem_put(map, key, (char *)0, data, (long)dlen, (un_long)0);
+    /* Other processes bump it too, so don't rely on os_atomic_add alone */
+    if (!os_sem_acquire(map->f_mutex, SHMEM_WAIT_MAX)) return;
+    os_atomic_add(&(cache->desc_gen), 1);
+    os_sem_release(map->f_mutex);
+}
+
+/*
+** Pass every describe result published for a location to loadfn
+*/
+void owa_shmem_desc_load(shm_context *map, owa_context *octx,
+                         void (*loadfn)(owa_context *octx, char *pname,
+                                        char *data, int dlen))
+{
+    shm_cache *cache;
+    shm_entry *ent;
+    un_long    off;
+    char      *sptr;
+    char       key[HTBUF_HEADER_MAX];
+    int        klen;
+    int        i;
+
+    cache = owa_shmem_cache(map);
+    if (!cache) return;
+    if ((str_length(octx->location) + 3) >= sizeof(key)) return;
+    klen = owa_shmem_desc_key(key, sizeof(key) - 1, octx->location, "");
+
+    if (!os_sem_acquire(map->f_mutex, SHMEM_WAIT_MAX)) return;
+    for (i = 0; i < SHM_HASH_SIZE; ++i)
+        for (off = cache->buckets[i]; off; off = ent->next)
+        {
+            ent = SHM_ENTRY(cache, off);
+            sptr = (char *)(ent + 1);
+            if ((ent->keylen > klen + 1) && (*sptr == '\001'))
+                if (!str_compare(sptr, key, klen, 0))
+                    (*loadfn)(octx, sptr + klen,
+                              sptr + ent->keylen + ent->typelen,
+                              ent->datalen);
+        }
+    os_sem_release(map->f_mutex);
+}
+
+/*
+** Remove every describe result published for a location
+*/
+void owa_shmem_desc_clear(shm_context *map, char *location)
+{
+    shm_cache *cache;
+    shm_entry *ent;
+    un_long    off;
+    un_long    nxt;
+    char      *sptr;
+    char       key[HTBUF_HEADER_MAX];
+    int        klen;
+    int        i;
+
+    cache = owa_shmem_cache(map);
+    if (!cache) return;
+    if ((str_length(location) + 3) >= sizeof(key)) return;
+    klen = owa_shmem_desc_key(key, sizeof(key) - 1, location, "");
+
+    if (!os_sem_acquire(map->f_mutex, SHMEM_WAIT_MAX)) return;
+    for (i = 0; i < SHM_HASH_SIZE; ++i)
+        for (off = cache->buckets[i]; off; off = nxt)
+        {
+            ent = SHM_ENTRY(cache, off);
+            nxt = ent->next;
+            sptr = (char *)(ent + 1);
+            if ((ent->keylen > klen + 1) && (*sptr == '\001'))
+                if (!str_compare(sptr, key, klen, 0))
+                    owa_shmem_cache_free(cache, off);
+        }
+    os_atomic_add(&(cache->desc_clears), 1);
+    os_atomic_add(&(cache->desc_gen), 1);
+    os_sem_release(map->f_mutex);
+}
+
+/*
+** Remove cached pages whose keys (physical file names) start with
+** prefix.  If interval is 0 every matching page is removed, as for
+** CLEARCACHE!; otherwise only pages older than both interval and a
+** non-zero life are removed, matching the file system purge.
+*/
+void owa_shmem_purge(shm_context *map, char *prefix,
+                     un_long life, un_long interval)
+{
+    shm_cache *cache;
+    shm_entry *ent;
+    un_long    off;
+    un_long    nxt;
+    un_long    curtime;
+    un_long    fage;
+    char      *sptr;
+    int        plen;
+    int        i;
+
+    cache = owa_shmem_cache(map);
+    if (!cache) return;
+    if ((interval > 0) && (life == 0)) return;
+    plen = str_length(prefix);
+    if (plen == 0) return;
+    curtime = os_get_time((un_long *)0);
+
+    if (!os_sem_acquire(map->f_mutex, SHMEM_WAIT_MAX)) return;
+    for (i = 0; i < SHM_HASH_SIZE; ++i)
+        for (off = cache->buckets[i]; off; off = nxt)
+        {
+            ent = SHM_ENTRY(cache, off);
+            nxt = ent->next;
+            sptr = (char *)(ent + 1);
+            if ((*sptr == '\001') || (ent->keylen <= plen)) continue;
+            if (str_compare(sptr, prefix, plen, 0)) continue;
+            if (interval > 0)
+            {
+                fage = curtime - ent->ctime;
+                if ((fage <= interval) || (fage <= life)) continue;
+            }
+            owa_shmem_cache_free(cache, off);
+        }
+    os_sem_release(map->f_mutex);
+}
+
+/*
+** Print shared memory page cache statistics
+*/
+static void owa_shmem_cache_show(shm_context *map, request_rec *r)
+{
+    shm_cache *cache;
+    un_long    hits, misses, stores, evicts, brk, arena;
+
+    cache = owa_shmem_cache(map);
+    if (!cache) return;
+    if (!os_sem_acquire(map->f_mutex, SHMEM_WAIT_MAX)) return;
+    hits = cache->hits;
+    misses = cache->misses;
+    stores = cache->stores;
+    evicts = cache->evicts;
+    brk = cache->brk;
+    arena = cache->arena;
+    os_sem_release(map->f_mutex);
+
+    morq_write(r, "<p><b>Shared memory cache</b><br>\n", -1);
+    morq_print_int(r, "Size %d bytes, ", (long)arena);
+    morq_print_int(r, "%d in use<br>\n", (long)brk);
+    morq_print_int(r, "Hits %d, ", (long)hits);
+    morq_print_int(r, "misses %d, ", (long)misses);
+    morq_print_int(r, "stores %d, ", (long)stores);
+    morq_print_int(r, "evictions %d</p>\n", (long)evicts);
+}
+#else
+int owa_shmem_desc_gen(shm_context *map)
+{
+    return(-1);
+}
+
+int owa_shmem_desc_clears(shm_context *map)
+{
+    return(-1);
+}
+
+void owa_shmem_desc_put(shm_context *map, char *location, char *pname,
+                        char *data, int dlen)
+{
+}
+
+void owa_shmem_desc_load(shm_context *map, owa_context *octx,
+                         void (*loadfn)(owa_context *octx, char *pname,
+                                        char *data, int dlen))
+{
+}
+
+void owa_shmem_desc_clear(shm_context *map, char *location)
+{
+}
+
+void owa_shmem_purge(shm_context *map, char *prefix,
+                     un_long life, un_long interval)
+{
+}
+#endif
+
+/*
+** Select the list a free pool slot belongs on, based on its state
+*/
+static pool_list *owa_pool_list(owa_context *octx, connection *c)
+{
+    if (c->c_lock == C_LOCK_AVAILABLE)
+        return((c->session) ? &(octx->c_sess) : &(octx->c_free));
+    if (c->c_lock == C_LOCK_UNUSED)
+        return(&(octx->c_unused));
+    if (c->c_lock == C_LOCK_RESET)
+        return(&(octx->c_reset));
+    return((pool_list *)0);
+}
+
+/*
+** Build the free lists from the current state of the pool.
+** ### CALLER MUST HOLD THE POOL MUTEX ###
+*/
+void owa_pool_init(owa_context *octx)
+{
+    int         i;
+    connection *c;
+
+    octx->c_unused.head = octx->c_unused.tail = (connection *)0;
+    octx->c_free.head = octx->c_free.tail = (connection *)0;
+    octx->c_sess.head = octx->c_sess.tail = (connection *)0;
+    octx->c_reset.head = octx->c_reset.tail = (connection *)0;
+    for (i = 0; i < POOL_HASH_SIZE; ++i) octx->c_hash[i] = (connection *)0;
+
+    /* Link in reverse, so that the lowest slots are at the head */
+    for (i = octx->poolsize - 1; i >= 0; --i)
+    {
+        c = octx->c_pool + i;
+        c->c_next = c->c_prev = c->c_hnext = (connection *)0;
+        owa_pool_link(octx, c);
+    }
+}
+
+/*
+** Put a free slot at the head of the list for its state.  Slots with
+** a session are also entered in the session hash.
+** ### CALLER MUST HOLD THE POOL MUTEX ###
+*/
+void owa_pool_link(owa_context *octx, connection *c)
+{
+    pool_list *plist = owa_pool_list(octx, c);
+    int        h;
+
+    if (!plist) return;
+
+    c->c_prev = (connection *)0;
+    c->c_next = plist->head;
+    if (plist->head) plist->head->c_prev = c;
+    else             plist->tail = c;
+    plist->head = c;
+
+    if (plist == &(octx->c_sess))
+    {
+        h = (int)(str_hash(c->session, -1, 0) & (POOL_HASH_SIZE - 1));
+        c->c_hnext = octx->c_hash[h];
+        octx->c_hash[h] = c;
+    }
+}
+
+/*
+** Remove a free slot from its list (and the session hash).  Must be
+** called before the slot's state or session is changed.
+** ### CALLER MUST HOLD THE POOL MUTEX ###
+*/
+void owa_pool_unlink(owa_context *octx, connection *c)
+{
+    pool_list   *plist = owa_pool_list(octx, c);
+    connection **pptr;
+    int          h;
+
+    if (!plist) return;
+
+    if (c->c_prev) c->c_prev->c_next = c->c_next;
+    else           plist->head = c->c_next;
+    if (c->c_next) c->c_next->c_prev = c->c_prev;
+    else           plist->tail = c->c_prev;
+    c->c_next = c->c_prev = (connection *)0;
+
+    if (plist == &(octx->c_sess))
+    {
+        h = (int)(str_hash(c->session, -1, 0) & (POOL_HASH_SIZE - 1));
+        for (pptr = &(octx->c_hash[h]); *pptr; pptr = &((*pptr)->c_hnext))
+            if (*pptr == c)
+            {
+                *pptr = c->c_hnext;
+                break;
+            }
+        c->c_hnext = (connection *)0;
+    }
+}
+
+/*
+** Find a free slot whose connection holds the specified session
+** ### CALLER MUST HOLD THE POOL MUTEX ###
+*/
+connection *owa_pool_match(owa_context *octx, char *session)
+{
+    connection *c;
+    int         h;
+
+    h = (int)(str_hash(session, -1, 0) & (POOL_HASH_SIZE - 1));
+    for (c = octx->c_hash[h]; c; c = c->c_hnext)
+        if (!str_compare(c->session, session, -1, 0))
+            break;
+    return(c);
+}
+
+/*
+** Close idle connections at the cold end of a free list
+*/
+static void owa_pool_trim(owa_context *octx, pool_list *plist,
+                          long_64 curtime, int interval)
+{
+    sword       status;
+    un_long     elapsed;
+    connection *c;
+
+    /*
+    ** The list is kept in most-recently-used order, so work back from
+    ** the tail.  At the first connection that has been used within the
+    ** interval, stop and wait for the next pass.
+    */
+    while ((c = plist->tail) != (connection *)0)
+    {
+        elapsed = (un_long)((curtime - c->timestamp)/(long_64)1000000);
+        if (elapsed <= (un_long)interval) break;
+
+        /* Keep the warm floor of open connections */
+        if ((octx->poolstats[C_LOCK_AVAILABLE] +
+             octx->poolstats[C_LOCK_INUSE] +
+             octx->poolstats[C_LOCK_RESET]) <= octx->pool_min)
+            break;
+
+        owa_pool_unlink(octx, c);
+        status = sql_disconnect(c);
+        if (octx->diagflag  & DIAG_POOL)
+          debug_out(octx->diagfile,
+                    "Cleanup thread %d "
+                    "closed connection for %s with status %d\n",
+                    octx->location, 0, octx->realpid, status);
+        os_atomic_add(&(octx->poolstats[C_LOCK_AVAILABLE]), -1);
+        c->c_lock = C_LOCK_UNUSED;
+        os_atomic_add(&(octx->poolstats[c->c_lock]), 1);
+        owa_pool_link(octx, c);
+    }
+}
+
 /*
 ** Check for old connections and close them
 */
 void owa_pool_purge(owa_context *octx, int interval)
 {
-    int         i;
     long_64     curtime;
-    sword       status;
-    volatile connection *c_pool;
 
     if (!(octx->init_complete)) return;
 
@@ -687,47 +1719,17 @@ void owa_pool_purge(owa_context *octx, int interval)
     mowa_acquire_mutex(octx);
 
     /*
-    ** Reverse search the list, since the normal process of connection
-    ** assignment works from the head of the list.  At the first live
-    ** available connection, check the age; if it's been used within
-    ** the interval, then exit the loop immediately and wait for the
-    ** next pass.  Otherwise, close it, and continue looping.
+    ** Connections with and without sessions are kept on separate
+    ** lists, each in LRU order, so both can be trimmed from the tail.
     **
     ** ### AT SOME POINT WHEN "LOCKED" SESSIONING IS SUPPORTED, NEED TO
-    ** ### MAKE SOME CONNECTIONS IMMUNE FROM THIS PROCESS.  FOR NOW,
-    ** ### USE THE EXISTING LRU ALGORITHM, WITH A SMALL MODIFICATION.
+    ** ### MAKE SOME CONNECTIONS IMMUNE FROM THIS PROCESS.
     */
-    i = octx->poolsize;
-    while (i > 0)
-    {
-        c_pool = octx->c_pool + (--i);
-        if (c_pool->c_lock == C_LOCK_AVAILABLE)
-        {
-            un_long elapsed = (un_long)
-              ((curtime - c_pool->timestamp)/(long_64)1000000);
-            if (elapsed <= (un_long)interval)
-            {
-                /*
-                ** If sessioning is being used, the code can no longer
-                ** rely on the sessions being in LRU order, so the search
-                ** has to continue through the entire list.
-                */
-                if (octx->session)
-                    continue;
-                else
-                    break;
-            }
-            status = sql_disconnect((connection *)c_pool);
-            if (octx->diagflag  & DIAG_POOL)
-              debug_out(octx->diagfile,
-                        "Cleanup thread %d "
-                        "closed connection for %s with status %d\n",
-                        octx->location, 0, octx->realpid, status);
-            --(octx->poolstats[C_LOCK_AVAILABLE]);
-            c_pool->c_lock = C_LOCK_UNUSED;
-            ++(octx->poolstats[c_pool->c_lock]);
-        }
-    }
+    owa_pool_trim(octx, &(octx->c_free), curtime, interval);
+    owa_pool_trim(octx, &(octx->c_sess), curtime, interval);
+
+    /* Start measuring demand afresh for the next interval */
+    octx->pool_peak = octx->poolstats[C_LOCK_INUSE];
 
     owa_shmem_update(octx->mapmem, &(octx->shm_offset),
                      octx->realpid, octx->location, octx->poolstats);
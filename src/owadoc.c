@@ -88,6 +88,14 @@
 ** 07/14/2016   D. McMahon      Avoid 1460 errors on 32-bit OCIs
 ** 09/09/2016   D. McMahon      Fix separator search for: Shift-JIS, BIG-5, GBK
 ** 03/30/2022   D. McMahon      Use HTBUF_HEADER_MAX as LOB chunk size
+** 10/17/2026   D. McMahon      Precompute the boundary pattern for mem_scan
+** 10/17/2026   D. McMahon      Add read-ahead LOB download pipeline
+** 10/17/2026   D. McMahon      Prefetch owa_rlobtable BLOBs, skip LobOpen
+** 10/17/2026   D. McMahon      Add owa_rlobbatch and owa_rlobcache
+** 10/17/2026   D. McMahon      Add write-behind ring for streamed uploads
+** 10/17/2026   D. McMahon      Key document prefetch by user, bound it
+** 10/17/2026   D. McMahon      Close short uploads with a last piece, fail them
+** 10/17/2026   D. McMahon      Cache prefetched documents only with CACHE set
 */
 
 #define WITH_OCI
@@ -487,6 +495,7 @@ int owa_writedata(connection *c, owa_context *octx, request_rec *r,
     int            bound_flag;
     int            bin_flag = 0;
     int            blen;
+    mem_pattern    bpat;
     char          *aptr;
     char          *sptr;
     char          *filpath;
@@ -564,6 +573,7 @@ int owa_writedata(connection *c, owa_context *octx, request_rec *r,
     ret_file = ret_sql;
 
     blen = str_length(boundary);
+    mem_pattern_init(&bpat, boundary, blen);
 
     cs_id = nls_csid(octx->dad_csid);
 
@@ -613,7 +623,7 @@ int owa_writedata(connection *c, owa_context *octx, request_rec *r,
             n = i;
         }
 
-        sptr = mem_find(outbuf, (long_64)n, boundary, blen);
+        sptr = mem_scan(&bpat, outbuf, (long_64)n);
         if (sptr)
         {
             i = (int)(sptr - outbuf);
@@ -890,7 +900,7 @@ int owa_writedata(connection *c, owa_context *octx, request_rec *r,
                     ** Data until next boundary is content for this field
                     ** Contents limited to about 32K by this code
                     */
-                    aptr = mem_find(sptr, (long_64)(n - j), boundary, blen);
+                    aptr = mem_scan(&bpat, sptr, (long_64)(n - j));
                     /*
                     ** ### If the end of the field cannot be found,
                     ** ### the code just fails right now.  This is
@@ -1210,6 +1220,158 @@ static void parse_mime(owa_context *octx, request_rec *r, char *pmimetype)
     }
 }
 
+/*
+** LOB streaming state, shared with the read-ahead thread
+*/
+typedef struct lob_pipe
+{
+    connection    *c;
+    OCILobLocator *plob;
+    ub2            cs_id;
+    int            oversized;
+    ub1            piece;
+    long_64        total;       /* Bytes left to read, binary LOBs only  */
+    ub4            buflen;      /* Read size, a multiple of LOB chunks  */
+    char          *bufs[2];
+    ub4            nbytes[2];
+    sword          status[2];
+    int            last[2];
+    os_objptr      filled;      /* Count of buffers ready to send       */
+    os_objptr      emptied;     /* Count of buffers ready to read into  */
+} lob_pipe;
+
+/*
+** Read the next piece of a LOB in streaming mode
+*/
+static sword lob_stream_read(lob_pipe *lp, char *buf, ub4 buflen,
+                             ub4 *nbytes)
+{
+    sword status;
+
+    *nbytes = 0; /* Read data in LOB streaming mode */
+
+#ifdef OVERSIZED_LOBS
+    if (lp->oversized)
+    {
+        oraub8 byte_amt = 0;
+        status = OCILobRead2(lp->c->svchp, lp->c->errhp, lp->plob,
+                             &byte_amt, (oraub8 *)0, (oraub8)1,
+                             (dvoid *)buf, (oraub8)buflen,
+                             lp->piece, (dvoid *)0, NULL, lp->cs_id, (ub1)0);
+        lp->piece = OCI_NEXT_PIECE;
+        *nbytes = (ub4)byte_amt;
+    }
+    else /* Original code capable of only 2G reads */
+#endif
+    {
+        status = OCILobRead(lp->c->svchp, lp->c->errhp, lp->plob,
+                            nbytes, (ub4)1, (dvoid *)buf, buflen,
+                            (dvoid *)0, NULL, lp->cs_id, (ub1)0);
+    }
+    return(status);
+}
+
+/*
+** Read-ahead thread for owa_readlob: fills the two buffers in turn
+** while the request thread sends the other one to the client.  The
+** connection's OCI handles belong to this thread until it exits.
+*/
+static void lob_reader(void *ctx)
+{
+    lob_pipe *lp = (lob_pipe *)ctx;
+    int       slot = 0;
+    int       done = 0;
+    ub4       buflen;
+    sword     status;
+
+    while (!done)
+    {
+        os_cond_wait(lp->emptied, SHMEM_WAIT_INFINITE);
+
+        buflen = lp->buflen;
+        if ((long_64)buflen > lp->total) buflen = (ub4)lp->total;
+
+        status = lob_stream_read(lp, lp->bufs[slot], buflen,
+                                 &(lp->nbytes[slot]));
+        if (status == NEED_READ_DATA) status = OCI_SUCCESS;
+        else                          done = 1;
+        if (status != OCI_SUCCESS) done = 1;
+        if (lp->nbytes[slot] == 0) done = 1;
+
+        lp->total -= (long_64)(lp->nbytes[slot]);
+        if (lp->total <= 0) done = 1;
+
+        lp->status[slot] = status;
+        lp->last[slot] = done;
+        os_cond_signal(lp->filled);
+
+        slot ^= 1;
+    }
+}
+
+/*
+** Send a binary LOB with reads overlapped against client writes.
+** Returns OCI_CONTINUE if the read-ahead thread couldn't be started,
+** in which case nothing has been read and the caller proceeds serially.
+*/
+static sword lob_pipeline(request_rec *r, lob_pipe *lp, os_objhand fp)
+{
+    sword      status = OCI_SUCCESS;
+    int        slot = 0;
+    int        last = 0;
+    ub4        nbytes;
+    os_thrhand thand;
+    un_long    tid;
+
+    /*
+    ** Semaphores are created full and drained, because Windows can't
+    ** create one with a maximum count of zero.
+    */
+    lp->emptied = os_cond_init((char *)0, 2, 1);
+    lp->filled = os_cond_init((char *)0, 2, 1);
+    if ((!lp->emptied) || (!lp->filled))
+    {
+        if (lp->emptied) os_cond_destroy(lp->emptied);
+        if (lp->filled) os_cond_destroy(lp->filled);
+        return(OCI_CONTINUE);
+    }
+    os_cond_wait(lp->filled, 0);
+    os_cond_wait(lp->filled, 0);
+
+    thand = thread_spawn(lob_reader, (void *)lp, &tid);
+    if (InvalidThread(thand))
+    {
+        os_cond_destroy(lp->emptied);
+        os_cond_destroy(lp->filled);
+        return(OCI_CONTINUE);
+    }
+
+    while (!last)
+    {
+        os_cond_wait(lp->filled, SHMEM_WAIT_INFINITE);
+
+        status = lp->status[slot];
+        nbytes = lp->nbytes[slot];
+        last = lp->last[slot];
+        if ((status != OCI_SUCCESS) || (nbytes == 0)) break;
+
+#ifndef NO_FILE_CACHE
+        if (!InvalidFile(fp)) file_write_data(fp, lp->bufs[slot], (int)nbytes);
+#endif
+        morq_write(r, lp->bufs[slot], (long)nbytes);
+
+        os_cond_signal(lp->emptied);
+        slot ^= 1;
+    }
+
+    /* The reader always stops after the piece marked last */
+    thread_join(thand);
+    os_cond_destroy(lp->emptied);
+    os_cond_destroy(lp->filled);
+
+    return(status);
+}
+
 /*
 ** Read LOB data and download file
 */
@@ -1234,14 +1396,14 @@ int owa_readlob(connection *c, owa_context *octx, request_rec *r,
     int            range_flag = 0;
     long_64        range_offset = 0;
     long_64        range_length = -1;
+    lob_pipe       lp;
 #ifdef OVERSIZED_LOBS
     int            oversized_lob = 0;
-    ub1            piece = OCI_FIRST_PIECE;
 #endif
 #ifndef NO_FILE_CACHE
     char          *tempname = (char *)0;
-    os_objhand     fp = os_nullfilehand;
 #endif
+    os_objhand     fp = os_nullfilehand;
 
     if (c->blob_ind != (ub2)-1)
     {
@@ -1313,8 +1475,16 @@ int owa_readlob(connection *c, owa_context *octx, request_rec *r,
       total = (long_64)utotal;
     }
 
-    status = OCILobOpen(c->svchp, c->errhp, plob, OCI_LOB_READONLY);
-    if (status != OCI_SUCCESS) goto readerr;
+    /*
+    ** Internal LOBs are read in a single streaming pass, which opens
+    ** and closes them implicitly on the server, so an explicit open
+    ** would only add two round trips.  BFILEs must be opened.
+    */
+    if (plob == c->pbfile)
+    {
+        status = OCILobOpen(c->svchp, c->errhp, plob, OCI_LOB_READONLY);
+        if (status != OCI_SUCCESS) goto readerr;
+    }
 
     /*
     ** Set header Content-Type and status (unless called from owa_getpage)
@@ -1422,6 +1592,50 @@ int owa_readlob(connection *c, owa_context *octx, request_rec *r,
     offset = 0;
     last_flag = 0;
 
+    lp.c = c;
+    lp.plob = plob;
+    lp.cs_id = cs_id;
+#ifdef OVERSIZED_LOBS
+    lp.oversized = oversized_lob;
+#else
+    lp.oversized = 0;
+#endif
+    lp.piece = OCI_FIRST_PIECE;
+
+    /*
+    ** With OwaReadAhead, binary LOBs larger than a block are sent
+    ** through a pair of buffers so that the next OCILobRead overlaps
+    ** the client write of the previous one.  The block is rounded
+    ** down to a whole number of LOB chunks so each read lines up
+    ** with the storage.  BFILEs have no chunk size and use the block
+    ** size as given.
+    */
+    if ((bin_flag) && (!range_flag) &&
+        (octx->readahead > (long_64)HTBUF_BLOCK_READ) &&
+        (total > (long_64)HTBUF_BLOCK_READ))
+    {
+        ub4 chunk = 0;
+
+        lp.buflen = (ub4)octx->readahead;
+        if ((long_64)lp.buflen > total) lp.buflen = (ub4)total;
+        status = OCILobGetChunkSize(c->svchp, c->errhp, plob, &chunk);
+        if ((status == OCI_SUCCESS) && (chunk > 0) && (lp.buflen > chunk))
+            lp.buflen -= (lp.buflen % chunk);
+
+        lp.bufs[0] = (char *)morq_alloc(r, (size_t)lp.buflen * 2, 0);
+        if (lp.bufs[0])
+        {
+            lp.bufs[1] = lp.bufs[0] + lp.buflen;
+            lp.total = total;
+            status = lob_pipeline(r, &lp, fp);
+            if (status != OCI_CONTINUE)
+            {
+                if (status != OCI_SUCCESS) goto readerr;
+                goto closelob;
+            }
+        }
+    }
+
     while (total > 0)
     {
         if ((bin_flag) && ((long_64)buflen > total)) buflen = (ub4)total;
@@ -1434,26 +1648,7 @@ int owa_readlob(connection *c, owa_context *octx, request_rec *r,
         ** of raw data. Note that the offset is always 1 because it's
         ** relative to the current location within the stream.
         */
-        nbytes = 0; /* Read data in LOB streaming mode */
-
-#ifdef OVERSIZED_LOBS
-        if (oversized_lob)
-        {
-          oraub8 byte_amt = nbytes;
-          status = OCILobRead2(c->svchp, c->errhp, plob,
-                               &byte_amt, (oraub8 *)0, (oraub8)1,
-                               (dvoid *)outbuf, (oraub8)buflen,
-                               piece, (dvoid *)0, NULL, cs_id, (ub1)0);
-          piece = OCI_NEXT_PIECE;
-          nbytes = (ub4)byte_amt;
-        }
-        else /* Original code capable of only 2G reads */
-#endif
-        {
-          status = OCILobRead(c->svchp, c->errhp, plob,
-                              &nbytes, (ub4)1, (dvoid *)outbuf, buflen,
-                              (dvoid *)0, NULL, cs_id, (ub1)0);
-        }
+        status = lob_stream_read(&lp, outbuf, buflen, &nbytes);
 
         if (status == NEED_READ_DATA) status = OCI_SUCCESS;
         else                          last_flag = 1;
@@ -1511,7 +1706,9 @@ closelob:
       status = OCILobIsTemporary(c->envhp, c->errhp, plob, &is_temp);
       if (status != OCI_SUCCESS) is_temp = 0;
       if (is_temp) status = OCILobFreeTemporary(c->svchp, c->errhp, plob);
-      else         status = OCILobClose(c->svchp, c->errhp, plob);
+      else if (plob == c->pbfile)
+                   status = OCILobClose(c->svchp, c->errhp, plob);
+      else         status = OCI_SUCCESS;
     }
 
 readerr:
@@ -1710,6 +1907,25 @@ longerr:
     return(status);
 }
 
+/*
+** Set the content disposition if it wasn't already done
+*/
+static void set_disposition(request_rec *r, char *name, char *pcdisp)
+{
+    int slen;
+
+    if ((*name) && (!*pcdisp))
+    {
+        str_copy(pcdisp, "filename=\"");
+        slen = str_length(pcdisp);
+        slen = str_concat(pcdisp, slen, name, HTBUF_HEADER_MAX-2);
+        pcdisp[slen++] = '"';
+        pcdisp[slen] = '\0';
+        nls_sanitize_header(pcdisp);
+        morq_table_put(r, OWA_TABLE_HEADOUT, 0, "Content-Disposition", pcdisp);
+    }
+}
+
 /*
 ** Read from document table of the following spec:
 **
@@ -1743,13 +1959,18 @@ int owa_rlobtable(connection *c, owa_context *octx, request_rec *r,
     if ((!(octx->doc_column)) || (!(octx->doc_table)))
         return(status); /* ### Really should be an error ### */
 
-    /* Build the select statement */
-    str_copy(stmt, "begin select MIME_TYPE, DAD_CHARSET, ");
+    /*
+    ** Build the select statement.  This is a plain query rather than
+    ** a PL/SQL block so that the BLOB is a define, not a bind; only
+    ** defined locators can carry prefetched LOB data, which lets
+    ** small documents be sent without another round trip.
+    */
+    str_copy(stmt, "select MIME_TYPE, DAD_CHARSET, ");
     slen = str_length(stmt);
     slen = str_concat(stmt, slen, octx->doc_column, -1);
-    slen = str_concat(stmt, slen, " into :B1, :B2, :B3 from ", -1);
+    slen = str_concat(stmt, slen, " from ", -1);
     slen = str_concat(stmt, slen, octx->doc_table, -1);
-    slen = str_concat(stmt, slen, " where NAME = :B4; end;", -1);
+    slen = str_concat(stmt, slen, " where NAME = :B1", -1);
 
     c->lastsql = stmt;
     status = sql_parse(c, c->stmhp3, stmt, (ub4)slen);
@@ -1759,23 +1980,30 @@ int owa_rlobtable(connection *c, owa_context *octx, request_rec *r,
 
     charset = stmt + slen + 1;
 
-    status = sql_bind_str(c, c->stmhp3, (ub4)1,
-                          pmimetype, (sb4)HTBUF_HEADER_MAX);
+    status = sql_bind_str(c, c->stmhp3, (ub4)1, name, nlen);
     if (status != OCI_SUCCESS) goto rtaberr;
 
-    status = sql_bind_str(c, c->stmhp3, (ub4)2,
-                          charset, (sb4)HTBUF_HEADER_MAX);
+    /* Null columns leave the (pre-cleared) buffers untouched */
+    status = sql_define(c, c->stmhp3, (ub4)1, (dvoid *)pmimetype,
+                        (sb4)HTBUF_HEADER_MAX, (ub2)SQLT_STR, (dvoid *)0);
     if (status != OCI_SUCCESS) goto rtaberr;
 
-    status = sql_bind_lob(c, c->stmhp3, (ub4)3, SQLT_BLOB);
+    status = sql_define(c, c->stmhp3, (ub4)2, (dvoid *)charset,
+                        (sb4)HTBUF_HEADER_MAX, (ub2)SQLT_STR, (dvoid *)0);
     if (status != OCI_SUCCESS) goto rtaberr;
 
-    status = sql_bind_str(c, c->stmhp3, (ub4)4, name, nlen);
+    c->bfile_ind = (ub2)-1;
+    c->nlob_ind  = (ub2)-1;
+    c->clob_ind  = (ub2)-1;
+
+    status = sql_define_lob(c, c->stmhp3, (ub4)3, SQLT_BLOB,
+                            (ub4)(octx->lobprefetch));
     if (status != OCI_SUCCESS) goto rtaberr;
 
     *pmimetype = *charset = '\0';
 
-    status = sql_exec(c, c->stmhp3, (ub4)1, 0);
+    /* Exact fetch of one row, like SELECT INTO (no row is ORA-01403) */
+    status = sql_exec(c, c->stmhp3, (ub4)1, 1);
     if (status != OCI_SUCCESS) goto rtaberr;
 
     c->lastsql = (char *)0;
@@ -1793,18 +2021,7 @@ int owa_rlobtable(connection *c, owa_context *octx, request_rec *r,
         }
     }
 
-    /* Set the content disposition if it wasn't already done */
-    if ((*name) && (!*pcdisp))
-    {
-        int  slen;
-        str_copy(pcdisp, "filename=\"");
-        slen = str_length(pcdisp);
-        slen = str_concat(pcdisp, slen, name, HTBUF_HEADER_MAX-2);
-        pcdisp[slen++] = '"';
-        pcdisp[slen] = '\0';
-        nls_sanitize_header(pcdisp);
-        morq_table_put(r, OWA_TABLE_HEADOUT, 0, "Content-Disposition", pcdisp);
-    }
+    set_disposition(r, name, pcdisp);
 
 rtaberr:
     if (status != OCI_SUCCESS)
@@ -1819,6 +2036,423 @@ rtaberr:
     return(status);
 }
 
+/*
+** Send a document prefetched by owa_rlobbatch, if it's in the cache.
+** The user is the database user the request connects as, if that
+** varies by request (OwaRealm), else null.  Returns 1 if the response
+** was sent, else 0 (and the caller should use owa_rlobtable).
+*/
+int owa_rlobcache(owa_context *octx, request_rec *r, char *user,
+                  char *name, char *pmimetype, char *pcdisp)
+{
+#ifndef NO_FILE_CACHE
+    char    *data;
+    long     dlen;
+    int      range_flag = 0;
+    long_64  range_offset;
+    long_64  range_length;
+
+    if ((!(octx->mapmem)) || (!(octx->doc_table)) || (!name) || (!*name))
+        return(0);
+    if (octx->doclife <= 0) return(0);
+
+    *pmimetype = '\0';
+    dlen = owa_shmem_doc_get(octx->mapmem, r, octx->location, user, name,
+                             (un_long)(octx->doclife), pmimetype, &data);
+    if (dlen < 0) return(0);
+
+    set_disposition(r, name, pcdisp);
+    morq_set_mimetype(r, pmimetype);
+    if (mowa_check_keepalive(octx->keepalive_flag))
+    {
+        morq_set_length(r, (size_t)dlen, 0);
+        range_flag = morq_check_range(r);
+    }
+    morq_send_header(r);
+
+    if (range_flag)
+    {
+        while (morq_get_range(r, &range_offset, &range_length))
+            morq_write(r, data + range_offset, (long)range_length);
+    }
+    else if (dlen > 0)
+        morq_write(r, data, dlen);
+
+    return(1);
+#else
+    return(0);
+#endif
+}
+
+/*
+** Fetch the documents named in a comma-separated list from the
+** document table and put the small ones in the shared memory cache,
+** so the requests that follow for them can be served by owa_rlobcache.
+** All rows come back from one array fetch; with OwaDocLobs PREFETCH
+** their BLOB contents come back with them, too.  Nothing is cached
+** unless OwaDocLobs CACHE sets how long copies may be served stale.
+**
+** The statement always has CACHE_DOC_BATCH binds, so that it can be
+** shared; unused binds repeat the first name.  Names past the batch
+** size, and names that are already cached, are skipped, and reading
+** stops after CACHE_DOC_BYTES.  Since this holds the connection, it's
+** skipped altogether while other requests are queued for one.
+** Failures here don't affect the page, which has already been sent.
+*/
+int owa_rlobbatch(connection *c, owa_context *octx, request_rec *r,
+                  char *user, char *names, char *outbuf)
+{
+    sword          status = OCI_SUCCESS;
+#ifndef NO_FILE_CACHE
+    sb4            oerrno;
+    sb4            nlen;
+    ub4            nrows = 0;
+    ub4            amount;
+    un_long        total = 0;
+    int            nnames = 0;
+    int            nlocs = 0;
+    int            slen;
+    int            i, j;
+    char          *stmt = outbuf;
+    char          *sptr;
+    char          *eptr;
+    char          *rbuf;
+    char          *data = (char *)0;
+    char           bname[16];
+    char           ctype[HTBUF_LINE_LENGTH];
+    char          *bnames[CACHE_DOC_BATCH];
+    sb2            ninds[CACHE_DOC_BATCH];
+    sb2            tinds[CACHE_DOC_BATCH];
+    sb2            cinds[CACHE_DOC_BATCH];
+    sb2            linds[CACHE_DOC_BATCH];
+    OCILobLocator *locs[CACHE_DOC_BATCH];
+    shm_context   *map = octx->mapmem;
+
+    if ((!map) || (!(octx->doc_column)) || (!(octx->doc_table)) || (!names))
+        return(status);
+    if (octx->doclife <= 0) return(status);
+
+    /* Unlocked peek; a stale value just means one more or one fewer */
+    if (octx->q_tail != octx->q_head) return(status);
+
+    /* Split the list, skipping documents that are already cached */
+    for (sptr = names; (*sptr) && (nnames < CACHE_DOC_BATCH); sptr = eptr)
+    {
+        while ((*sptr == ' ') || (*sptr == ',')) ++sptr;
+        for (eptr = sptr; (*eptr) && (*eptr != ','); ++eptr);
+        j = (*eptr != '\0');
+        for (i = (int)(eptr - sptr); (i > 0) && (sptr[i - 1] == ' '); --i);
+        sptr[i] = '\0';
+        if (j) ++eptr;
+        if ((i > 0) && (i < HTBUF_LINE_CHARS))
+            if (!owa_shmem_doc_check(map, octx->location, user, sptr,
+                                     (un_long)(octx->doclife)))
+                bnames[nnames++] = sptr;
+    }
+    if (nnames == 0) return(status);
+
+    /* Build the select statement */
+    str_copy(stmt, "select NAME, MIME_TYPE, DAD_CHARSET, ");
+    slen = str_length(stmt);
+    slen = str_concat(stmt, slen, octx->doc_column, -1);
+    slen = str_concat(stmt, slen, " from ", -1);
+    slen = str_concat(stmt, slen, octx->doc_table, -1);
+    slen = str_concat(stmt, slen, " where NAME in (", -1);
+    for (i = 0; i < CACHE_DOC_BATCH; ++i)
+    {
+        bname[0] = ':';
+        bname[1] = 'B';
+        str_itoa(i + 1, bname + 2);
+        if (i > 0) slen = str_concat(stmt, slen, ", ", -1);
+        slen = str_concat(stmt, slen, bname, -1);
+    }
+    slen = str_concat(stmt, slen, ")", -1);
+
+    rbuf = (char *)morq_alloc(r, (size_t)(HTBUF_LINE_LENGTH * 3 * nnames), 0);
+    if (!rbuf) return(status);
+
+    for (nlocs = 0; nlocs < nnames; ++nlocs)
+    {
+        status = OCIDescriptorAlloc(c->envhp, (dvoid **)&(locs[nlocs]),
+                                    (ub4)OCI_DTYPE_LOB, (size_t)0,
+                                    (dvoid **)0);
+        if (status != OCI_SUCCESS) goto rbaterr;
+    }
+
+    c->lastsql = stmt;
+    status = sql_parse(c, c->stmhp3, stmt, (ub4)slen);
+    if (status != OCI_SUCCESS) goto rbaterr;
+
+    for (i = 0; i < CACHE_DOC_BATCH; ++i)
+    {
+        sptr = bnames[(i < nnames) ? i : 0];
+        nlen = (sb4)util_round((un_long)(str_length(sptr) + 1),
+                               octx->scale_round);
+        status = sql_bind_str(c, c->stmhp3, (ub4)(i + 1), sptr, nlen);
+        if (status != OCI_SUCCESS) goto rbaterr;
+    }
+
+    status = sql_define(c, c->stmhp3, (ub4)1, (dvoid *)rbuf,
+                        (sb4)HTBUF_LINE_LENGTH, (ub2)SQLT_STR,
+                        (dvoid *)ninds);
+    if (status != OCI_SUCCESS) goto rbaterr;
+
+    status = sql_define(c, c->stmhp3, (ub4)2,
+                        (dvoid *)(rbuf + HTBUF_LINE_LENGTH * nnames),
+                        (sb4)HTBUF_LINE_LENGTH, (ub2)SQLT_STR,
+                        (dvoid *)tinds);
+    if (status != OCI_SUCCESS) goto rbaterr;
+
+    status = sql_define(c, c->stmhp3, (ub4)3,
+                        (dvoid *)(rbuf + HTBUF_LINE_LENGTH * 2 * nnames),
+                        (sb4)HTBUF_LINE_LENGTH, (ub2)SQLT_STR,
+                        (dvoid *)cinds);
+    if (status != OCI_SUCCESS) goto rbaterr;
+
+    status = sql_define_lobarr(c, c->stmhp3, (ub4)4, locs, linds,
+                               (ub4)(octx->lobprefetch));
+    if (status != OCI_SUCCESS) goto rbaterr;
+
+    status = sql_exec(c, c->stmhp3, (ub4)nnames, 0);
+    if (status == OCI_NO_DATA) status = OCI_SUCCESS; /* Fewer rows */
+    if (status != OCI_SUCCESS) goto rbaterr;
+
+    status = sql_get_rowcount(c, c->stmhp3, &nrows);
+    if (status != OCI_SUCCESS) goto rbaterr;
+    if (nrows > (ub4)nnames) nrows = (ub4)nnames;
+
+    for (i = 0; i < (int)nrows; ++i)
+    {
+        if ((ninds[i] == (sb2)-1) || (linds[i] == (sb2)-1)) continue;
+
+        status = OCILobGetLength(c->svchp, c->errhp, locs[i], &amount);
+        if (status != OCI_SUCCESS) goto rbaterr;
+        if ((size_t)amount > map->memthresh) continue;
+        if ((total + (un_long)amount) > (un_long)CACHE_DOC_BYTES) break;
+        total += (un_long)amount;
+
+        if (!data)
+        {
+            data = (char *)morq_alloc(r, map->memthresh + 1, 0);
+            if (!data) break;
+        }
+        if (amount > 0)
+        {
+            status = OCILobRead(c->svchp, c->errhp, locs[i],
+                                &amount, (ub4)1, (dvoid *)data, amount,
+                                (dvoid *)0, NULL, (ub2)0, (ub1)0);
+            if (status != OCI_SUCCESS) goto rbaterr;
+        }
+
+        /* Content type as owa_rlobtable would set it */
+        sptr = rbuf + HTBUF_LINE_LENGTH * i;
+        *ctype = '\0';
+        if (tinds[i] != (sb2)-1)
+            str_concat(ctype, 0, rbuf + HTBUF_LINE_LENGTH * (nnames + i),
+                       HTBUF_LINE_CHARS);
+        util_set_mime(sptr, ctype, 1);
+        if ((*ctype) && (cinds[i] != (sb2)-1))
+        {
+            eptr = rbuf + HTBUF_LINE_LENGTH * (nnames * 2 + i);
+            if (*eptr)
+            {
+                slen = str_length(ctype);
+                slen = str_concat(ctype, slen, "; charset=",
+                                  HTBUF_LINE_LENGTH - 1);
+                str_concat(ctype, slen, eptr, HTBUF_LINE_LENGTH - 1);
+            }
+        }
+
+        owa_shmem_doc_put(map, octx->location, user, sptr, ctype,
+                          data, (long)amount);
+    }
+
+rbaterr:
+    if (status != OCI_SUCCESS)
+    {
+        oerrno = sql_get_error(c);
+        if (oerrno) status = oerrno;
+    }
+    else
+    {
+        c->lastsql = (char *)0;
+    }
+    for (i = 0; i < nlocs; ++i)
+        OCIDescriptorFree((dvoid *)(locs[i]), (ub4)OCI_DTYPE_LOB);
+#endif
+    return(status);
+}
+
+/*
+** LOB upload state, shared with the write-behind thread
+*/
+#define LOB_RING_SLOTS 4
+
+typedef struct lob_ring
+{
+    connection    *c;
+    OCILobLocator *plob;
+    long_64        position;    /* Offset of the next piece, from 1     */
+    ub4            buflen;      /* Slot size, a multiple of LOB chunks  */
+    sword          status;      /* Set by the writer, first error wins  */
+    char          *bufs[LOB_RING_SLOTS];
+    ub4            nbytes[LOB_RING_SLOTS];
+    int            last[LOB_RING_SLOTS];
+    os_objptr      filled;      /* Count of slots ready to write        */
+    os_objptr      emptied;     /* Count of slots ready to read into    */
+} lob_ring;
+
+/*
+** Write the next piece of a LOB in streaming mode
+*/
+static sword lob_stream_write(connection *c, OCILobLocator *plob,
+                              long_64 position, char *buf, ub4 nbytes,
+                              ub1 piece)
+{
+    sword status;
+#ifdef OVERSIZED_LOBS
+    oraub8 bamt = (oraub8)nbytes;
+
+    status = OCILobWrite2(c->svchp, c->errhp, plob,
+                          &bamt, (oraub8 *)0, (oraub8)position,
+                          (dvoid *)buf, (oraub8)nbytes, piece,
+                          (dvoid *)0, NULL, c->csid, (ub1)0);
+#else
+    ub4 bamt = nbytes;
+
+    status = OCILobWrite(c->svchp, c->errhp, plob,
+                         &bamt, (ub4)position, (dvoid *)buf, nbytes, piece,
+                         (dvoid *)0, NULL, c->csid, (ub1)0);
+#endif
+    if (status == NEED_WRITE_DATA) status = OCI_SUCCESS;
+    return(status);
+}
+
+/*
+** Write-behind thread for owa_wlobtable: drains the ring slots in
+** order while the request thread refills the others from the client.
+** The connection's OCI handles belong to this thread until it exits.
+** After an error it keeps releasing slots without writing them, so
+** the request thread never blocks on a full ring.
+*/
+static void lob_writer(void *ctx)
+{
+    lob_ring *lr = (lob_ring *)ctx;
+    int       slot = 0;
+    int       last = 0;
+    ub1       piece = OCI_FIRST_PIECE;
+    ub4       nbytes;
+
+    while (!last)
+    {
+        os_cond_wait(lr->filled, SHMEM_WAIT_INFINITE);
+
+        nbytes = lr->nbytes[slot];
+        last = lr->last[slot];
+
+        /*
+        ** An empty last slot (the client stopped short) still has to
+        ** close a write that's under way
+        */
+        if ((lr->status == OCI_SUCCESS) &&
+            ((nbytes > 0) || ((last) && (piece != OCI_FIRST_PIECE))))
+        {
+            if (last)
+                piece = (piece == OCI_FIRST_PIECE) ? OCI_ONE_PIECE
+                                                   : OCI_LAST_PIECE;
+            lr->status = lob_stream_write(lr->c, lr->plob, lr->position,
+                                          lr->bufs[slot], nbytes, piece);
+            lr->position += (long_64)nbytes;
+            piece = OCI_NEXT_PIECE;
+        }
+
+        os_cond_signal(lr->emptied);
+        slot = (slot + 1) % LOB_RING_SLOTS;
+    }
+}
+
+/*
+** Stream a request body into a LOB with client reads overlapped
+** against LOB writes.  Each slot is filled completely before it is
+** handed over, so every piece but the last is a whole number of LOB
+** chunks.  Returns OCI_CONTINUE if the write-behind thread couldn't
+** be started, in which case nothing has been read and the caller
+** proceeds serially.  Otherwise *ptotal is reduced by the bytes read,
+** so it's non-zero after a successful return if the body was short.
+*/
+static sword lob_upload(request_rec *r, lob_ring *lr, long_64 *ptotal)
+{
+    long_64    total = *ptotal;
+    int        slot = 0;
+    int        last = 0;
+    int        n;
+    ub4        nbytes;
+    long       chunksz;
+    os_thrhand thand;
+    un_long    tid;
+
+    /*
+    ** Semaphores are created full and drained, because Windows can't
+    ** create one with a maximum count of zero.  All slots start empty.
+    */
+    lr->emptied = os_cond_init((char *)0, LOB_RING_SLOTS, 1);
+    lr->filled = os_cond_init((char *)0, LOB_RING_SLOTS, 1);
+    if ((!lr->emptied) || (!lr->filled))
+    {
+        if (lr->emptied) os_cond_destroy(lr->emptied);
+        if (lr->filled) os_cond_destroy(lr->filled);
+        return(OCI_CONTINUE);
+    }
+    for (n = 0; n < LOB_RING_SLOTS; ++n) os_cond_wait(lr->filled, 0);
+
+    lr->status = OCI_SUCCESS;
+    thand = thread_spawn(lob_writer, (void *)lr, &tid);
+    if (InvalidThread(thand))
+    {
+        os_cond_destroy(lr->emptied);
+        os_cond_destroy(lr->filled);
+        return(OCI_CONTINUE);
+    }
+
+    while (!last)
+    {
+        os_cond_wait(lr->emptied, SHMEM_WAIT_INFINITE);
+
+        /* Stop reading once the writer has failed */
+        nbytes = 0;
+        if (lr->status != OCI_SUCCESS) last = 1;
+
+        while ((!last) && (nbytes < lr->buflen))
+        {
+            chunksz = (long)(lr->buflen - nbytes);
+            if ((long_64)chunksz > total) chunksz = (long)total;
+            n = morq_read(r, lr->bufs[slot] + nbytes, chunksz);
+            if (n <= 0)
+            {
+                last = 1; /* Short body, reported by the caller */
+                break;
+            }
+            nbytes += (ub4)n;
+            total -= (long_64)n;
+            if (total == 0) last = 1;
+        }
+
+        lr->nbytes[slot] = nbytes;
+        lr->last[slot] = last;
+        os_cond_signal(lr->filled);
+
+        slot = (slot + 1) % LOB_RING_SLOTS;
+    }
+
+    /* The writer always stops after the slot marked last */
+    thread_join(thand);
+    os_cond_destroy(lr->emptied);
+    os_cond_destroy(lr->filled);
+
+    *ptotal = total;
+    return(lr->status);
+}
+
 /*
 ** Write to document table of the following spec:
 **
@@ -1966,22 +2600,69 @@ int owa_wlobtable(connection *c, owa_context *octx, request_rec *r,
           /* If the file length is 0, it has to be read from the request. */
           if (filelist->len == 0)
           {
-            int     n;
+            int     n, k;
+            int     piped = 0;
             ub1     piece_flag = OCI_FIRST_PIECE;
+            ub4     chunk = 0;
             long    chunksz = HTBUF_BLOCK_SIZE;
             long_64 position = (long_64)1;
             long_64 bytes_remaining = (long_64)(filelist->total);
 
+            /*
+            ** Size the writes to whole LOB chunks so that each piece
+            ** lands on the storage without a read-modify-write.
+            */
+            status = OCILobGetChunkSize(c->svchp, c->errhp, c->pblob, &chunk);
+            if (status != OCI_SUCCESS) chunk = 0;
+            status = OCI_SUCCESS;
+            if ((chunk > 0) && ((long)chunk < chunksz))
+                chunksz -= (chunksz % (long)chunk);
+
+            /*
+            ** With OwaWriteBehind, bodies larger than one slot go through
+            ** a ring of slots drained by a helper thread, so the client
+            ** read of the next slot overlaps the LOB write of the last.
+            */
+            if ((octx->writebehind > (long_64)HTBUF_BLOCK_SIZE) &&
+                (bytes_remaining > octx->writebehind))
+            {
+              lob_ring lr;
+
+              lr.c = c;
+              lr.plob = c->pblob;
+              lr.position = position;
+              lr.buflen = (ub4)octx->writebehind;
+              if ((chunk > 0) && (lr.buflen > chunk))
+                lr.buflen -= (lr.buflen % chunk);
+
+              lr.bufs[0] = (char *)morq_alloc(r, (size_t)lr.buflen *
+                                                 LOB_RING_SLOTS, 0);
+              if (lr.bufs[0])
+              {
+                for (n = 1; n < LOB_RING_SLOTS; ++n)
+                  lr.bufs[n] = lr.bufs[n - 1] + lr.buflen;
+                status = lob_upload(r, &lr, &bytes_remaining);
+                if (status != OCI_CONTINUE)
+                  piped = 1; /* Done, successfully or not */
+                else
+                  status = OCI_SUCCESS;
+              }
+            }
+
             /*
             ** Streaming reads from the request input stream
             ** and streaming writes to the LOB
             */
-            while (bytes_remaining > 0)
+            while ((!piped) && (bytes_remaining > 0))
             {
               if ((long_64)chunksz > bytes_remaining)
                 chunksz = (long)bytes_remaining;
-              n = morq_read(r, outbuf, chunksz);
-              if (n <= 0) break; /* ### Should be a hard error ### */
+              for (n = 0; n < (int)chunksz; n += k)
+              {
+                k = morq_read(r, outbuf + n, chunksz - (long)n);
+                if (k <= 0) break;
+              }
+              if (n <= 0) break; /* Short body, reported below */
 
               bytes_remaining -= (long_64)n;
 
@@ -1993,29 +2674,33 @@ int owa_wlobtable(connection *c, owa_context *octx, request_rec *r,
                   piece_flag = OCI_LAST_PIECE;
               }
 
-              {
-#ifdef OVERSIZED_LOBS
-                oraub8 bamt = (oraub8)n;
-                oraub8 offset = (oraub8)position;
-                status = OCILobWrite2(c->svchp, c->errhp, c->pblob,
-                                      &bamt, (oraub8 *)0, offset,
-                                      outbuf, bamt, piece_flag,
-                                      (dvoid *)0, NULL, c->csid, (ub1)0);
-#else
-                ub4 bamt = (ub4)n;
-                ub4 offset = (ub4)position;
-                status = OCILobWrite(c->svchp, c->errhp, c->pblob,
-                                     &bamt, offset, outbuf, bamt, piece_flag,
-                                     (dvoid *)0, NULL, c->csid, (ub1)0);
-#endif
-
-                if (status != OCI_SUCCESS) break;
-              }
+              status = lob_stream_write(c, c->pblob, position,
+                                        outbuf, (ub4)n, piece_flag);
+              if (status != OCI_SUCCESS) break;
 
               piece_flag = OCI_NEXT_PIECE;
 
               position += (long_64)n;
             }
+
+            /* Close a piecewise write the client left unfinished */
+            if ((!piped) && (status == OCI_SUCCESS) &&
+                (bytes_remaining > 0) && (piece_flag == OCI_NEXT_PIECE))
+              status = lob_stream_write(c, c->pblob, position,
+                                        outbuf, (ub4)0, OCI_LAST_PIECE);
+
+            /*
+            ** Don't hand a truncated document to the procedure; report
+            ** it the way the OCI errors here are reported.
+            */
+            if ((status == OCI_SUCCESS) && (bytes_remaining > 0))
+            {
+              os_str_print(c->errbuf,
+                           "Upload of [%s] ended short of its length",
+                           tempname);
+              status = OCI_ERROR;
+              goto wtabshort;
+            }
           }
           /* Write data to the open lob in a single piece */
 #ifdef OVERSIZED_LOBS
@@ -2042,6 +2727,7 @@ int owa_wlobtable(connection *c, owa_context *octx, request_rec *r,
 
           if (status != OCI_SUCCESS) goto wtaberr;
         }
+
       }
 
       /* Do fixup on the parameters bound to PL/SQL */
@@ -2078,5 +2764,6 @@ wtaberr:
     {
         c->lastsql = (char *)0;
     }
+wtabshort:
     return(status);
 }
@@ -114,6 +114,9 @@
 ** os_cond_destroy()
 **   Destroy the condition variable.
 **
+** os_atomic_add()
+**   Atomically add to an integer and return the new value.
+**
 ** mem_alloc()
 **   Allocate memory from process heap.
 **
@@ -159,10 +162,18 @@
 ** file_close()
 **   Close a file.
 **
+** file_dup()
+**   Duplicate a file handle, so that the file stays open (as the same
+**   file) after the original is closed.
+**
 ** file_open_read()
 **   Given a file path, attempts to open the file for read
 **   and "stat" it to get the size in bytes and the age in seconds.
 **
+** file_stat()
+**   Given a file path, get the size in bytes and the time of last
+**   modification (in seconds since 1970) without opening the file.
+**
 ** file_map()
 **   Open a file mapping object.
 **
@@ -319,6 +330,14 @@
 ** 02/25/2017   D. McMahon      Add os_env_dump()
 ** 12/19/2017   D. McMahon      Avoid 0-length writes in file_write_data()
 ** 10/18/2018   D. McMahon      Replace fstat() with stat()
+** 10/17/2026   D. McMahon      Add os_atomic_add()
+** 10/17/2026   D. McMahon      Add socket_writev()
+** 10/17/2026   D. McMahon      Add file_stat()
+** 10/17/2026   D. McMahon      Add socket_sendfile()
+** 10/17/2026   D. McMahon      Make thread_join wait on Windows
+** 10/17/2026   D. McMahon      Use native atomics or a mutex in os_atomic_add
+** 10/17/2026   D. McMahon      Return null from file_view if mmap fails
+** 10/17/2026   D. McMahon      Add file_dup()
 */
 
 
@@ -377,11 +396,23 @@ extern char **environ;
 #  include <sys/socket.h>
 #  include <netinet/in.h> /* For htons() */
 #  include <arpa/inet.h>  /* For inet_addr(), inet_aton(), inet_ntop() */
+#  include <sys/uio.h>    /* For writev() */
+#  ifdef LINUX
+#   include <sys/sendfile.h> /* For sendfile() */
+#  endif
 # endif
 
 /* Less portable Unix headers */
 # include <pthread.h>
 # include <signal.h>
+# ifndef __GNUC__
+#  ifdef SUN_OS5
+#   include <atomic.h>        /* For atomic_add_int_nv() */
+#  endif
+#  ifdef AIX
+#   include <sys/atomic_op.h> /* For fetch_and_add() */
+#  endif
+# endif
 # ifndef WITH_IPC
 #  define WITH_IPC
 # endif
@@ -892,6 +923,50 @@ int os_cond_destroy(os_objptr mh)
     return(1);
 }
 
+/*
+** Add delta to *ptr and return the new value, as one indivisible
+** operation with a full memory barrier.  Compilers without a native
+** primitive (e.g. HP-UX aCC) fall back to a process-wide mutex, which
+** serializes threads but not processes; counters in shared memory
+** must be updated under the shared memory semaphore on those.
+*/
+#ifndef MODOWA_WINDOWS
+# ifndef __GNUC__
+#  ifndef SUN_OS5
+#   ifndef AIX
+static pthread_mutex_t atomic_mutex = PTHREAD_MUTEX_INITIALIZER;
+#   endif
+#  endif
+# endif
+#endif
+
+int os_atomic_add(volatile int *ptr, int delta)
+{
+#ifdef MODOWA_WINDOWS
+    return((int)InterlockedExchangeAdd((LONG volatile *)ptr,
+                                       (LONG)delta) + delta);
+#else
+#ifdef __GNUC__
+    return(__sync_add_and_fetch(ptr, delta));
+#else
+#ifdef SUN_OS5
+    return((int)atomic_add_int_nv((volatile uint_t *)ptr, delta));
+#else
+#ifdef AIX
+    return(fetch_and_add((atomic_p)ptr, delta) + delta);
+#else
+    int val;
+
+    pthread_mutex_lock(&atomic_mutex);
+    val = (*ptr += delta);
+    pthread_mutex_unlock(&atomic_mutex);
+    return(val);
+#endif
+#endif
+#endif
+#endif
+}
+
 void *mem_alloc(size_t sz)
 {
 #ifdef MODOWA_WINDOWS
@@ -1200,6 +1275,17 @@ void file_close(os_objhand fp)
     if (fp != INVALID_HANDLE_VALUE) CloseHandle(fp);
 }
 
+os_objhand file_dup(os_objhand fp)
+{
+    HANDLE dfp;
+
+    if (InvalidFile(fp)) return(INVALID_HANDLE_VALUE);
+    if (!DuplicateHandle(GetCurrentProcess(), fp, GetCurrentProcess(),
+                         &dfp, 0, FALSE, DUPLICATE_SAME_ACCESS))
+        return(INVALID_HANDLE_VALUE);
+    return(dfp);
+}
+
 int file_lock(os_objhand fp, int shared, int blocking, int unlock)
 {
     BOOL  result;
@@ -1263,6 +1349,20 @@ os_objhand file_open_read(char *fpath, un_long *fsz, un_long *fage)
     return(fh);
 }
 
+int file_stat(char *fpath, un_long *fsz, un_long *ftime)
+{
+    WIN32_FILE_ATTRIBUTE_DATA st;
+
+    if (!GetFileAttributesEx(fpath, GetFileExInfoStandard, &st))
+        return(-1);
+    if (st.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+        return(-1);
+    *fsz = (un_long)st.nFileSizeLow;
+    *ftime = os_unix_time(st.ftLastWriteTime.dwLowDateTime,
+                          st.ftLastWriteTime.dwHighDateTime, (un_long *)0);
+    return(0);
+}
+
 os_objhand file_map(os_objhand fp, un_long fsz,
                     char *mapname, int write_flag)
 {
@@ -1493,6 +1593,12 @@ void file_close(os_objhand fp)
     if (fp >= 0) close(fp);
 }
 
+os_objhand file_dup(os_objhand fp)
+{
+    if (fp < 0) return(-1);
+    return(dup(fp));
+}
+
 #ifndef NO_FILE_CACHE
 
 os_objhand file_open_read(char *fpath, un_long *fsz, un_long *fage)
@@ -1519,6 +1625,19 @@ os_objhand file_open_read(char *fpath, un_long *fsz, un_long *fage)
     return(fd);
 }
 
+int file_stat(char *fpath, un_long *fsz, un_long *ftime)
+{
+    struct stat st;
+
+    if (stat(fpath, &st) != 0)
+        return(-1);
+    if (st.st_mode & S_IFDIR)
+        return(-1);
+    *fsz   = (un_long)st.st_size;
+    *ftime = (un_long)st.st_mtime;
+    return(0);
+}
+
 os_objhand file_map(os_objhand fp, un_long fsz,
                     char *mapname, int write_flag)
 {
@@ -1535,6 +1654,7 @@ void *file_view(os_objhand hnd, un_long fsz, int write_flag)
         prot = PROT_READ;
         if (write_flag) prot |= PROT_WRITE;
         ptr = mmap((void *)0, (size_t)fsz, prot, MAP_SHARED, hnd, (off_t)0);
+        if (ptr == MAP_FAILED) ptr = (void *)0;
     }
     return(ptr);
 }
@@ -1735,7 +1855,10 @@ os_thrhand thread_spawn(void (*thread_start)(void *),
     if (status == 0)
       tid = (un_long)th;
     else
+    {
       tid = (un_long)os_nullthrhand;
+      th = (pthread_t)os_nullthrhand;
+    }
 
     if (out_tid) *out_tid = tid;
 #endif
@@ -1762,7 +1885,10 @@ void thread_shutdown(os_thrhand th)
 
 void thread_join(os_thrhand th)
 {
-#ifndef MODOWA_WINDOWS
+#ifdef MODOWA_WINDOWS
+    WaitForSingleObject(th, INFINITE);
+    CloseHandle(th);
+#else
     pthread_join(th, (void **)0);
 #endif
 }
@@ -2057,6 +2183,127 @@ int socket_write(os_socket sock, char *buffer, int buflen)
     return(n);
 }
 
+/*
+** Write an array of fixed-width slices to a socket, gathering
+** up to SOCKET_IOV_MAX of them into each system call.
+*/
+#define SOCKET_IOV_MAX 64
+
+#ifdef MODOWA_WINDOWS
+# define IOV_BUF(v) ((v).buf)
+# define IOV_LEN(v) ((v).len)
+#else
+# define IOV_BUF(v) ((v).iov_base)
+# define IOV_LEN(v) ((v).iov_len)
+#endif
+
+int socket_writev(os_socket sock, char *buffer, int stride,
+                  un_short *lens, int nvec)
+{
+#ifdef MODOWA_WINDOWS
+    WSABUF        iov[SOCKET_IOV_MAX];
+    DWORD         m;
+#else
+    struct iovec  iov[SOCKET_IOV_MAX];
+    int           m;
+#endif
+    int n = 0;
+    int i, j, k;
+
+    i = 0;
+    while (i < nvec)
+    {
+        /* Gather the next set of non-empty slices */
+        for (j = 0; (i < nvec) && (j < SOCKET_IOV_MAX); ++i)
+        {
+            if (lens[i] == 0) continue;
+            IOV_BUF(iov[j]) = buffer + (i * stride);
+            IOV_LEN(iov[j]) = lens[i];
+            ++j;
+        }
+
+        /* Write them, picking up where any short write left off */
+        k = 0;
+        while (k < j)
+        {
+#ifdef MODOWA_WINDOWS
+            if (WSASend(sock, iov + k, (DWORD)(j - k), &m, 0, NULL, NULL))
+                return(-1);
+#else
+            m = (int)writev(sock, iov + k, j - k);
+            if (m < 0) return(m);
+#endif
+            if (m == 0) return(n);
+            n += (int)m;
+            while ((k < j) && (m >= IOV_LEN(iov[k])))
+            {
+                m -= IOV_LEN(iov[k]);
+                ++k;
+            }
+            if (k < j)
+            {
+                IOV_BUF(iov[k]) = (char *)IOV_BUF(iov[k]) + m;
+                IOV_LEN(iov[k]) -= m;
+            }
+        }
+    }
+    return(n);
+}
+
+/*
+** Send part of an open file to a socket.  On Linux this uses
+** sendfile() so that the data never passes through user space;
+** elsewhere it falls back to reads and writes through a local buffer.
+** Returns SEND_FILE_UNAVAILABLE if sendfile() can't be used on the
+** file and nothing was sent, or SEND_FILE_FAILED if the transfer
+** stops before len bytes.
+*/
+long_64 socket_sendfile(os_socket sock, os_objhand fp,
+                        long_64 off, long_64 len)
+{
+#ifdef LINUX
+    off_t    foff = (off_t)off;
+    ssize_t  m;
+    size_t   chunk;
+#else
+    char     buffer[HTBUF_BLOCK_SIZE];
+    int      chunk;
+    int      m;
+#endif
+    long_64  n = 0;
+
+#ifdef LINUX
+    while (n < len)
+    {
+        chunk = (size_t)0x40000000;
+        if ((long_64)chunk > (len - n)) chunk = (size_t)(len - n);
+        m = sendfile(sock, fp, &foff, chunk);
+        if (m < 0)
+        {
+            if (errno == EINTR) continue;
+            if ((n == 0) && ((errno == EINVAL) || (errno == ENOSYS)))
+                return(SEND_FILE_UNAVAILABLE);
+            return(SEND_FILE_FAILED);
+        }
+        if (m == 0) break;
+        n += (long_64)m;
+    }
+#else
+    file_seek(fp, (long)off);
+    while (n < len)
+    {
+        chunk = (int)sizeof(buffer);
+        if ((long_64)chunk > (len - n)) chunk = (int)(len - n);
+        m = file_read_data(fp, buffer, chunk);
+        if (m <= 0) break;
+        if (socket_write(sock, buffer, m) != m) return(SEND_FILE_FAILED);
+        n += (long_64)m;
+    }
+#endif
+    if (n < len) return(SEND_FILE_FAILED);
+    return(n);
+}
+
 /*
 ** Read from a socket
 */
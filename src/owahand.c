@@ -128,6 +128,31 @@
 ** 07/04/2022   D. McMahon      Fix handling of empty string in array pivot
 ** 03/07/2023   D. McMahon      OwaHeader support
 ** 05/08/2023   D. McMahon      Fix volatile markings in the code
+** 10/17/2026   D. McMahon      Add fused CGI environment/procedure call
+** 10/17/2026   D. McMahon      Show statement cache counters on SHOWPOOL!
+** 10/17/2026   D. McMahon      Close shared session pool in owa_cleanup
+** 10/17/2026   D. McMahon      Use per-state free lists in lock_connection
+** 10/17/2026   D. McMahon      Evict coldest session, show affinity counters
+** 10/17/2026   D. McMahon      Hash describe cache, add SHOWDESCRIBE!
+** 10/17/2026   D. McMahon      Share describe cache through shared memory
+** 10/17/2026   D. McMahon      Fix inverted name test in cached promotion
+** 10/17/2026   D. McMahon      Add describe preloading
+** 10/17/2026   D. McMahon      Hash argument names, grow arrays geometrically
+** 10/17/2026   D. McMahon      Pass CGI environment by pointer, not padded
+** 10/17/2026   D. McMahon      Defer package resets to the cleanup thread
+** 10/17/2026   D. McMahon      Add owa_pool_warm
+** 10/17/2026   D. McMahon      Add FIFO admission queue with 503 shedding
+** 10/17/2026   D. McMahon      Precompute multipart boundaries for mem_scan
+** 10/17/2026   D. McMahon      Prefetch documents announced by X-Owa-Prefetch
+** 10/17/2026   D. McMahon      Spill large POST bodies to a mapped temp file
+** 10/17/2026   D. McMahon      Reclaim describe entries by epoch, copy for display
+** 10/17/2026   D. McMahon      Flush the local describe cache on a shared clear
+** 10/17/2026   D. McMahon      Run the describe preload from the cleanup thread
+** 10/17/2026   D. McMahon      Queue only when the pool is exhausted, wake waiters
+** 10/17/2026   D. McMahon      Key prefetched documents by realm user
+** 10/17/2026   D. McMahon      Don't spill POST bodies on Windows
+** 10/17/2026   D. McMahon      Recheck the describe epoch after joining a slot
+** 10/17/2026   D. McMahon      Use the argument index in owautil.c
 */
 
 #define WITH_OCI
@@ -145,6 +170,17 @@
 # define OWA_USE_ALLOCA
 #endif
 
+/*
+** Define this to let OwaSpill write large POST bodies to mapped temp
+** files.  Temp files are opened write-only on Windows, where they
+** can't be mapped, so bodies are always read into memory there.
+*/
+#ifndef NO_FILE_CACHE
+# ifndef MODOWA_WINDOWS
+#  define OWA_SPILL_ARGS
+# endif
+#endif
+
 #define ERRBUF_SIZE  OCI_ERROR_MAXMSG_SIZE+HTBUF_HEADER_MAX+SQL_NAME_MAX+50
 
 static char empty_string[] = "\0";
@@ -183,103 +219,114 @@ static void get_pid_tid_str(owa_context *octx, char *pid)
 static void *resize_arr(request_rec *r, void *ptr, int elsize, int currsz)
 {
     void *mptr;
-    mptr = morq_alloc(r, (currsz + HTBUF_PARAM_CHUNK) * elsize, 1);
+    mptr = morq_alloc(r, (currsz + ARR_GROWTH(currsz)) * elsize, 1);
     if (mptr) mem_copy(mptr, ptr, currsz * elsize);
     return(mptr);
 }
 
+/*
+** Allocate memory for an argument index from the request pool
+*/
+static void *argx_alloc(void *actx, size_t sz, int zero_flag)
+{
+    return(morq_alloc((request_rec *)actx, sz, zero_flag));
+}
+
+/*
+** Set up an empty argument index for a request
+*/
+static void argx_start(request_rec *r, arg_index *ax)
+{
+    mem_zero(ax, sizeof(*ax));
+    ax->afunc = argx_alloc;
+    ax->actx = (void *)r;
+}
+
 /*
 ** Find an available connection or slot in the pool and return it
 */
-static connection *lock_connection(owa_context *octx, char *session)
+static connection *lock_connection(owa_context *octx, char *session,
+                                   int wait_ms)
 {
-    int                   i;
+    int                   lock_state = C_LOCK_AVAILABLE;
     connection * volatile cptr;
 
     if (octx->poolsize == 0) return((connection *)0);
 
-    cptr = octx->c_pool;
-
-    if (!mowa_semaphore_get(octx)) return((connection *)0);
+    if (!mowa_semaphore_get(octx, wait_ms)) return((connection *)0);
     mowa_acquire_mutex(octx);
 
+    cptr = (connection *)0;
+
     if (!session) /* First-available search */
     {
-        /* Search for any reusable or available connection handle/slot */
-        for (i = 0; i < octx->poolsize; ++i)
-        {
-            if ((cptr->c_lock == C_LOCK_UNUSED) ||
-                (cptr->c_lock == C_LOCK_AVAILABLE))
-                break;
-            ++cptr;
-        }
+        /*
+        ** Prefer a live connection, then one still waiting for its
+        ** package reset (cheaper than a new login), then an empty slot;
+        ** only take a connection holding a session if nothing else is
+        ** free, and then take the least-recently used one.
+        */
+        cptr = octx->c_free.head;
+        if (!cptr) cptr = octx->c_reset.tail;
+        if (!cptr) cptr = octx->c_unused.head;
+        if (!cptr) cptr = octx->c_sess.tail;
     }
     else /* Session-matching search */
     {
         /* First see if there is a session match */
-        for (i = 0; i < octx->poolsize; ++i)
-        {
-            if (cptr->session)
-              if (!str_compare(cptr->session, session, -1, 0))
-                if ((cptr->c_lock == C_LOCK_UNUSED) ||
-                    (cptr->c_lock == C_LOCK_AVAILABLE))
-                  break;
-            ++cptr;
-        }
+        cptr = owa_pool_match(octx, session);
+        if (cptr) ++(octx->sess_hits);
 
-        /* Then look for a connection with no session */
-        if (i == octx->poolsize)
-        {
-            cptr = octx->c_pool;
-            for (i = 0; i < octx->poolsize; ++i)
-            {
-                if (cptr->session == (char *)0)
-                  if ((cptr->c_lock == C_LOCK_UNUSED) ||
-                      (cptr->c_lock == C_LOCK_AVAILABLE))
-                    break;
-                ++cptr;
-            }
-        }
+        /* Then look for a connection or slot with no session */
+        if (!cptr) cptr = octx->c_free.head;
+        if (!cptr) cptr = octx->c_reset.tail;
+        if (!cptr) cptr = octx->c_unused.head;
 
         /*
-        ** Finally, look for any connection
+        ** Finally, evict the coldest connection belonging to some
+        ** other session
         **
         ** ### AT SOME POINT WE MIGHT WANT TO SUPPORT "LOCKED" SESSIONING,
         ** ### WHERE A PERSISTENT SESSION IS MAINTAINED.  IN THAT SITUATION,
         ** ### THE CODE NEEDS TO SKIP THIS STEP AND PRODUCE SOME SORT OF
         ** ### ERROR RETURN
         */
-        if (i == octx->poolsize)
+        if (!cptr)
         {
-            cptr = octx->c_pool;
-            for (i = 0; i < octx->poolsize; ++i)
-            {
-                if ((cptr->c_lock == C_LOCK_UNUSED) ||
-                    (cptr->c_lock == C_LOCK_AVAILABLE))
-                    break;
-                ++cptr;
-            }
+            cptr = octx->c_sess.tail;
+            if (cptr) ++(octx->sess_evicts);
         }
+        ++(octx->sess_lookups);
     }
 
-    if (i < octx->poolsize)
+    if (cptr)
     {
-        --(octx->poolstats[cptr->c_lock]);
-        ++(octx->poolstats[C_LOCK_INUSE]);
-        ++(cptr->c_lock);
+        owa_pool_unlink(octx, cptr);
+        lock_state = cptr->c_lock;
+        if (lock_state != C_LOCK_RESET)
+            ++(cptr->c_lock);
+        else
+        {
+            /* The caller must run the reset the cleanup thread didn't */
+            cptr->c_lock = C_LOCK_INUSE;
+            cptr->reset_due = 1;
+        }
         cptr->slotnum = (int)(cptr - octx->c_pool);
-    }
-    else
-        cptr = (connection *)0;
-
-    if (!cptr)
-        mowa_semaphore_put(octx);
-    else
+        os_atomic_add(&(octx->poolstats[lock_state]), -1);
+        os_atomic_add(&(octx->poolstats[C_LOCK_INUSE]), 1);
+        if (octx->poolstats[C_LOCK_INUSE] > octx->pool_peak)
+            octx->pool_peak = octx->poolstats[C_LOCK_INUSE];
         owa_shmem_update(octx->mapmem, &(octx->shm_offset),
                          octx->realpid, octx->location, octx->poolstats);
+    }
 
     mowa_release_mutex(octx);
 
+    if (!cptr) mowa_semaphore_put(octx);
+
+    /* Demand has outrun the warm connections; open more ahead of it */
+    else if (lock_state == C_LOCK_UNUSED) mowa_thread_wake(octx);
+
     return((connection *)cptr);
 }
 
@@ -294,18 +341,245 @@ static void unlock_connection(owa_context *octx, connection *c)
 
     t = os_get_component_time(0);
     if (cptr->c_lock == C_LOCK_INUSE)        lock_state = C_LOCK_AVAILABLE;
+    else if (cptr->c_lock == C_LOCK_RESET)   lock_state = C_LOCK_RESET;
     else if (cptr->c_lock != C_LOCK_OFFLINE) lock_state = C_LOCK_UNUSED;
     else                                     lock_state = C_LOCK_OFFLINE;
-    --(octx->poolstats[C_LOCK_INUSE]);
-    ++(octx->poolstats[lock_state]);
-    mowa_acquire_mutex(octx);
+    os_atomic_add(&(octx->poolstats[C_LOCK_INUSE]), -1);
+    os_atomic_add(&(octx->poolstats[lock_state]), 1);
     cptr->mem_err = 0;
     cptr->timestamp = util_component_to_stamp(t);
+    mowa_acquire_mutex(octx);
     cptr->c_lock = lock_state;
+    owa_pool_link(octx, cptr);
     owa_shmem_update(octx->mapmem, &(octx->shm_offset),
                      octx->realpid, octx->location, octx->poolstats);
     mowa_release_mutex(octx);
     mowa_semaphore_put(octx);
+    if (lock_state == C_LOCK_RESET) mowa_thread_wake(octx);
+}
+
+/*
+** Wait in line for a connection from the pool.  Requests are served in
+** ticket order, and only the head of the line waits on the pool itself;
+** the rest sleep until the request ahead of them leaves the head of the
+** line and wakes them.  Every request's deadline is OwaWait
+** after it took its ticket, so the deadlines fall in ticket order too,
+** and nobody has to leave from the middle of the line: everyone ahead
+** has gone by the time a request's own deadline arrives.  Returns null,
+** with *shed set, if the line is full or the deadline passes.
+*/
+static connection *queue_connection(owa_context *octx, char *session,
+                                    int *shed)
+{
+    connection *c;
+    int         ticket;
+    int         elapsed;
+    int         next;
+    int         i;
+    long_64     tstart;
+
+    mowa_acquire_mutex(octx);
+    if ((octx->q_tail - octx->q_head) >= octx->q_limit)
+    {
+        ++(octx->qstats[QSTAT_SHED]);
+        mowa_release_mutex(octx);
+        owa_shmem_queue(octx->mapmem, octx->shm_offset, octx->qstats);
+        *shed = 1;
+        return((connection *)0);
+    }
+    ticket = (octx->q_tail)++;
+    octx->qstats[QSTAT_DEPTH] = octx->q_tail - octx->q_head;
+    mowa_release_mutex(octx);
+
+    tstart = util_component_to_stamp(os_get_component_time(0));
+    while (1)
+    {
+        elapsed = (int)((util_component_to_stamp(os_get_component_time(0)) -
+                         tstart)/(long_64)1000);
+        if (octx->q_head == ticket) break;
+        /* The timeout is only a backstop for a lost wakeup */
+        i = octx->pool_wait_ms - elapsed;
+        if (i < QUEUE_POLL_MS) i = QUEUE_POLL_MS;
+        mowa_queue_wait(octx, ticket, i);
+    }
+
+    c = (connection *)0;
+    if (elapsed < octx->pool_wait_ms)
+        c = lock_connection(octx, session, octx->pool_wait_ms - elapsed);
+
+    elapsed = (int)((util_component_to_stamp(os_get_component_time(0)) -
+                     tstart)/(long_64)1000);
+    for (i = 0; (i < QUEUE_BUCKETS - 1) && ((1 << i) <= elapsed); ++i);
+
+    mowa_acquire_mutex(octx);
+    next = ++(octx->q_head);
+    octx->qstats[QSTAT_DEPTH] = octx->q_tail - octx->q_head;
+    ++(octx->qstats[QSTAT_WAITS + i]);
+    if (!c) ++(octx->qstats[QSTAT_SHED]);
+    if (octx->q_tail == next) next = -1;
+    mowa_release_mutex(octx);
+
+    if (next >= 0) mowa_queue_wake(octx, next);
+
+    owa_shmem_queue(octx->mapmem, octx->shm_offset, octx->qstats);
+
+    if (!c) *shed = 1;
+    return(c);
+}
+
+/*
+** Estimate a percentile of queue wait time from the histogram; returns
+** the upper bound of the bucket it falls in, in milliseconds.
+*/
+static int queue_percentile(int *qstats, int pct)
+{
+    int i;
+    int total = 0;
+    int count = 0;
+
+    for (i = 0; i < QUEUE_BUCKETS; ++i) total += qstats[QSTAT_WAITS + i];
+    for (i = 0; i < QUEUE_BUCKETS - 1; ++i)
+    {
+        count += qstats[QSTAT_WAITS + i];
+        if ((count * 100) >= (total * pct)) break;
+    }
+    return(1 << i);
+}
+
+/*
+** Run the package resets deferred by put_connection.  Called from the
+** cleanup thread; each slot is taken through the pool semaphore like a
+** request would, so that waiting requests never find the pool empty.
+** If requests are already waiting, they'll run the resets themselves.
+*/
+void owa_pool_reset(owa_context *octx)
+{
+    connection *c;
+    sword       status;
+    int         lock_state;
+
+    if (!(octx->init_complete)) return;
+
+    while (octx->poolstats[C_LOCK_RESET] > 0)
+    {
+        if (!mowa_semaphore_get(octx, 0)) break;
+
+        mowa_acquire_mutex(octx);
+        c = octx->c_reset.tail;
+        if (c)
+        {
+            owa_pool_unlink(octx, c);
+            c->c_lock = C_LOCK_INUSE;
+            os_atomic_add(&(octx->poolstats[C_LOCK_RESET]), -1);
+            os_atomic_add(&(octx->poolstats[C_LOCK_INUSE]), 1);
+        }
+        mowa_release_mutex(octx);
+
+        if (!c)
+        {
+            mowa_semaphore_put(octx);
+            break;
+        }
+
+        /* There's no request to report an error to */
+        c->errbuf = (char *)0;
+        status = owa_reset(c, octx);
+        if (status != OCI_SUCCESS) sql_disconnect(c);
+
+        if (octx->diagflag & DIAG_POOL)
+          debug_out(octx->diagfile,
+                    "Cleanup thread %d "
+                    "reset connection for %s with status %d\n",
+                    octx->location, (char *)0, octx->realpid, status);
+
+        /* Return it to the pool, same as unlock_connection */
+        lock_state = (c->c_lock == C_LOCK_INUSE) ? C_LOCK_AVAILABLE
+                                                 : C_LOCK_UNUSED;
+        mowa_acquire_mutex(octx);
+        os_atomic_add(&(octx->poolstats[C_LOCK_INUSE]), -1);
+        os_atomic_add(&(octx->poolstats[lock_state]), 1);
+        c->c_lock = lock_state;
+        owa_pool_link(octx, c);
+        owa_shmem_update(octx->mapmem, &(octx->shm_offset),
+                         octx->realpid, octx->location, octx->poolstats);
+        mowa_release_mutex(octx);
+        mowa_semaphore_put(octx);
+    }
+}
+
+/*
+** Open connections ahead of demand, up to the larger of the configured
+** warm floor and the recent peak of connections in use.  Called from
+** the cleanup thread.  This is skipped until a request has set up the
+** NLS environment, and for OwaRealm, where every login is a user's.
+*/
+void owa_pool_warm(owa_context *octx)
+{
+    connection *c;
+    sword       status;
+    sb4         errinfo;
+    int         target;
+    int         nwarm;
+    char        errbuf[ERRBUF_SIZE];
+
+    if (!(octx->init_complete)) return;
+    if (!(octx->nls_init)) return;
+    if (octx->authrealm) return;
+
+    target = octx->pool_min;
+    if (octx->pool_peak > target) target = octx->pool_peak;
+    if (target > octx->poolsize) target = octx->poolsize;
+
+    while (1)
+    {
+        nwarm = octx->poolstats[C_LOCK_AVAILABLE] +
+                octx->poolstats[C_LOCK_INUSE] +
+                octx->poolstats[C_LOCK_RESET];
+        if (nwarm >= target) break;
+
+        if (!mowa_semaphore_get(octx, 0)) break;
+
+        mowa_acquire_mutex(octx);
+        c = octx->c_unused.head;
+        if (c)
+        {
+            owa_pool_unlink(octx, c);
+            c->c_lock = C_LOCK_NEW;
+            c->slotnum = (int)(c - octx->c_pool);
+            os_atomic_add(&(octx->poolstats[C_LOCK_UNUSED]), -1);
+            os_atomic_add(&(octx->poolstats[C_LOCK_INUSE]), 1);
+        }
+        mowa_release_mutex(octx);
+
+        if (!c)
+        {
+            mowa_semaphore_put(octx);
+            break;
+        }
+
+        *errbuf = '\0';
+        c->errbuf = errbuf;
+        status = sql_connect(c, octx, (char *)0, (char *)0, &errinfo);
+        if (status == OCI_SUCCESS)
+        {
+            sql_set_nls(c, octx);
+            c->c_lock = C_LOCK_INUSE;
+        }
+        else
+            sql_disconnect(c);
+        c->errbuf = (char *)0;
+
+        if (octx->diagflag & DIAG_POOL)
+          debug_out(octx->diagfile,
+                    "Cleanup thread %d "
+                    "opened connection for %s with status %d\n",
+                    octx->location, (char *)0, octx->realpid, status);
+
+        unlock_connection(octx, c);
+
+        /* Don't retry a failing login until the next wakeup */
+        if (status != OCI_SUCCESS) break;
+    }
 }
 
 /*
@@ -366,6 +640,7 @@ static void owa_setup(owa_context *octx, request_rec *r)
     if (octx->lobtypes < 0) octx->lobtypes = LOB_MODE_NCHAR;
 
     octx->poolstats[C_LOCK_UNUSED] = octx->poolsize;
+    owa_pool_init(octx);
 
     /* Logging is incompatible with some get-page return modes */
     if (octx->altflags & (ALT_MODE_LOBS | ALT_MODE_RAW | ALT_MODE_GETRAW))
@@ -447,29 +722,600 @@ static void revise_statement(char *stmt, int nargs, ub4 *counts)
 }
 
 /*
-** Inject a clause to force the HTBUF_LEN to a smaller limit
-** working around a multibyte bug in the PL/SQL gateway.
+** Inject a clause to force the HTBUF_LEN to a smaller limit
+** working around a multibyte bug in the PL/SQL gateway.
+*/
+static char *set_db_bufsize(char *sptr, int dbchsz)
+{
+  switch (dbchsz)
+  {
+  case 2:
+    sptr += str_concat(sptr, 0, "  HTP.HTBUF_LEN := 127;\n", -1);
+    break;
+
+  case 3:
+    sptr += str_concat(sptr, 0, "  HTP.HTBUF_LEN := 85;\n", -1);
+    break;
+
+  case 4:
+    sptr += str_concat(sptr, 0, "  HTP.HTBUF_LEN := 63;\n", -1);
+    break;
+
+  default:
+    break;
+  }
+  return(sptr);
+}
+
+/*
+** The describe cache is a case-insensitive hash table.  Lookups walk
+** the chains without taking the mutex; instead they count themselves
+** in one of two desc_readers slots, chosen by the parity of the
+** current desc_epoch.  Updates are made under the mutex and replace
+** the old entry for a procedure in a single pointer store.  Entries
+** that have been unlinked go on a retired list tagged with the epoch
+** they were retired in; see desc_reclaim.  All of this relies on
+** os_atomic_add being indivisible and a full barrier, on every
+** platform.  A lookup that counts itself in a slot only after the
+** epoch has moved on backs out and tries again, so desc_reclaim never
+** sees a drained slot that a lookup is about to join.
+*/
+static int desc_enter(owa_context *octx)
+{
+    int slot;
+
+    for (;;)
+    {
+        slot = (os_atomic_add(&(octx->desc_epoch), 0) & 1);
+        os_atomic_add(&(octx->desc_readers[slot]), 1);
+        if ((os_atomic_add(&(octx->desc_epoch), 0) & 1) == slot) break;
+        os_atomic_add(&(octx->desc_readers[slot]), -1);
+    }
+    return(slot);
+}
+
+static void desc_leave(owa_context *octx, int slot)
+{
+    os_atomic_add(&(octx->desc_readers[slot]), -1);
+}
+
+/*
+** Find a procedure in the describe cache (call between desc_enter
+** and desc_leave, and don't use the result after desc_leave)
+*/
+static descstruct *desc_find(owa_context *octx, char *pname)
+{
+    descstruct *dptr;
+    un_long     h;
+
+    h = str_hash(pname, -1, 1);
+    for (dptr = octx->desc_hash[h % DESC_HASH_SIZE];
+         dptr != (descstruct *)0;
+         dptr = dptr->next)
+    {
+        if (dptr->hashval == h)
+            if (str_compare(dptr->pname, pname, -1, 1) == 0)
+            {
+                dptr->lastuse =
+                    (un_long)(unsigned)os_atomic_add(&(octx->desc_clock), 1);
+                break;
+            }
+    }
+    return(dptr);
+}
+
+/*
+** Unlink an entry from its hash chain and retire it (mutexed)
+*/
+static void desc_unlink(owa_context *octx, descstruct *dptr)
+{
+    descstruct **pptr;
+
+    pptr = &(octx->desc_hash[dptr->hashval % DESC_HASH_SIZE]);
+    while (*pptr)
+    {
+        if (*pptr == dptr)
+        {
+            *pptr = dptr->next;
+            dptr->rgen = octx->desc_epoch;
+            dptr->rnext = octx->desc_retired;
+            octx->desc_retired = dptr;
+            os_atomic_add(&(octx->desc_count), -1);
+            break;
+        }
+        pptr = &((*pptr)->next);
+    }
+}
+
+/*
+** Free retired entries that no lookup can still be holding (mutexed).
+** A lookup can only hold entries that were still linked when it began,
+** so once the slot of the previous epoch has drained, everything that
+** was retired before the current epoch is unreachable; the epoch then
+** advances so that the current slot can drain in turn.  Lookups are
+** short, so the old slot drains quickly even under steady load, and
+** new lookups never join it.
+*/
+static void desc_reclaim(owa_context *octx)
+{
+    descstruct **pptr;
+    descstruct  *dptr;
+    int          epoch;
+
+    if (!(octx->desc_retired)) return;
+    epoch = octx->desc_epoch;
+    if (os_atomic_add(&(octx->desc_readers[(epoch + 1) & 1]), 0) != 0)
+        return;
+    pptr = &(octx->desc_retired);
+    while ((dptr = *pptr))
+    {
+        if (dptr->rgen != epoch)
+        {
+            *pptr = dptr->rnext;
+            mem_free((void *)dptr);
+        }
+        else
+            pptr = &(dptr->rnext);
+    }
+    os_atomic_add(&(octx->desc_epoch), 1);
+}
+
+/*
+** Install a describe result, replacing any older one for the same
+** procedure, and evict the least-recently-used entry if the cache
+** is over its size limit (mutexed)
+*/
+static void desc_store(owa_context *octx, descstruct *nptr)
+{
+    descstruct **pptr;
+    descstruct  *dptr;
+    descstruct  *victim;
+    int          i;
+
+    nptr->hashval = str_hash(nptr->pname, -1, 1);
+    nptr->lastuse = (un_long)(unsigned)os_atomic_add(&(octx->desc_clock), 1);
+    nptr->rnext = (descstruct *)0;
+
+    pptr = &(octx->desc_hash[nptr->hashval % DESC_HASH_SIZE]);
+    for (dptr = *pptr; dptr != (descstruct *)0; dptr = dptr->next)
+    {
+        if (dptr->hashval == nptr->hashval)
+            if (str_compare(dptr->pname, nptr->pname, -1, 1) == 0)
+                break;
+        pptr = &(dptr->next);
+    }
+    nptr->next = (dptr) ? dptr->next : *pptr;
+
+    /* The atomic add doubles as a barrier before the entry is published */
+    os_atomic_add(&(octx->desc_count), (dptr) ? 0 : 1);
+    *pptr = nptr;
+    if (dptr)
+    {
+        dptr->rgen = octx->desc_epoch;
+        dptr->rnext = octx->desc_retired;
+        octx->desc_retired = dptr;
+    }
+
+    if ((octx->desc_max > 0) && (octx->desc_count > octx->desc_max))
+    {
+        victim = (descstruct *)0;
+        for (i = 0; i < DESC_HASH_SIZE; ++i)
+            for (dptr = octx->desc_hash[i]; dptr; dptr = dptr->next)
+                if ((dptr != nptr) &&
+                    ((!victim) || (dptr->lastuse < victim->lastuse)))
+                    victim = dptr;
+        if (victim) desc_unlink(octx, victim);
+    }
+
+    desc_reclaim(octx);
+}
+
+/*
+** Drop every entry from the local describe cache (mutexed)
+*/
+static void desc_flush(owa_context *octx)
+{
+    int i;
+
+    for (i = 0; i < DESC_HASH_SIZE; ++i)
+        while (octx->desc_hash[i])
+            desc_unlink(octx, octx->desc_hash[i]);
+    desc_reclaim(octx);
+}
+
+/*
+** Empty the describe cache
+*/
+static void desc_clear(owa_context *octx)
+{
+    mowa_acquire_mutex(octx);
+    desc_flush(octx);
+#ifndef NO_FILE_CACHE
+    if (octx->mapmem)
+    {
+        owa_shmem_desc_clear(octx->mapmem, octx->location);
+        octx->desc_gen = owa_shmem_desc_gen(octx->mapmem);
+        octx->desc_clears = owa_shmem_desc_clears(octx->mapmem);
+    }
+#endif
+    mowa_release_mutex(octx);
+}
+
+/*
+** Space needed to copy a describe cache entry for desc_show
+*/
+static int desc_show_size(descstruct *dptr)
+{
+    char *sptr;
+    int   slen;
+
+    slen = str_length(dptr->pname) + 3;
+    if (dptr->pargs)
+        for (sptr = dptr->pargs; *sptr; sptr += str_length(sptr) + 1)
+            slen += str_length(sptr) + 1;
+    return(slen);
+}
+
+/*
+** Print the contents of the describe cache.  The entries are copied
+** out first, so that a slow client doesn't hold up reclamation; each
+** copy is a flag character ('1' for 2-argument flexargs), the name,
+** and the null-separated collection argument names, ending with an
+** empty string.
+*/
+static void desc_show(owa_context *octx, request_rec *r)
+{
+    descstruct *dptr;
+    char       *sptr;
+    char       *buf;
+    int         bufsz;
+    int         blen;
+    int         slot;
+    int         i;
+
+    morq_print_str(r, "<p>Describe cache for location %s</p>\n",
+                   octx->location);
+    morq_print_int(r, "<p>%d entries", (long)octx->desc_count);
+    if (octx->desc_max > 0)
+        morq_print_int(r, " (limit %d)", (long)octx->desc_max);
+    morq_write(r, "</p>\n", -1);
+
+    /* Size the copy, allowing for entries added while it's made */
+    slot = desc_enter(octx);
+    bufsz = 1;
+    for (i = 0; i < DESC_HASH_SIZE; ++i)
+        for (dptr = octx->desc_hash[i]; dptr; dptr = dptr->next)
+            bufsz += desc_show_size(dptr);
+    bufsz += (bufsz >> 2) + HTBUF_LINE_LENGTH;
+    buf = (char *)morq_alloc(r, (size_t)bufsz, 0);
+    blen = 0;
+    if (buf)
+        for (i = 0; i < DESC_HASH_SIZE; ++i)
+            for (dptr = octx->desc_hash[i]; dptr; dptr = dptr->next)
+            {
+                if ((blen + desc_show_size(dptr)) >= bufsz) break;
+                buf[blen++] = (dptr->flex2) ? '1' : '0';
+                blen = str_concat(buf, blen, dptr->pname, bufsz - 1) + 1;
+                if (dptr->pargs)
+                    for (sptr = dptr->pargs; *sptr; sptr += str_length(sptr) + 1)
+                        blen = str_concat(buf, blen, sptr, bufsz - 1) + 1;
+                buf[blen++] = '\0';
+            }
+    desc_leave(octx, slot);
+
+    morq_write(r, "<table cellspacing=\"2\" cellpadding=\"2\""
+                  " border=\"0\">\n", -1);
+    for (i = 0; i < blen; ++i)
+    {
+        sptr = buf + i + 1;
+        morq_print_str(r, "<tr valign=\"top\"><td>%s</td><td>", sptr);
+        if (buf[i] == '1')
+            morq_write(r, "(2-argument flexible)", -1);
+        for (sptr += str_length(sptr) + 1; *sptr; sptr += str_length(sptr) + 1)
+            morq_print_str(r, "%s ", sptr);
+        morq_write(r, "</td></tr>\n", -1);
+        i = (int)(sptr - buf);
+    }
+    morq_write(r, "</table>\n", -1);
+}
+
+#ifndef NO_FILE_CACHE
+/*
+** When OwaSharedMemory is configured, describe results are also
+** published to the shared segment so that a describe done by one
+** process warms every process, and survives child process recycling.
+** The shared form is a flag character ('1' for 2-argument flexargs)
+** followed by the null-separated collection argument names.
+*/
+static void desc_publish(owa_context *octx, descstruct *dptr)
+{
+    char *data;
+    char *sptr;
+    int   dlen;
+
+    dlen = 2;
+    if (dptr->pargs)
+        for (sptr = dptr->pargs; *sptr; sptr += str_length(sptr) + 1)
+            dlen += str_length(sptr) + 1;
+
+    data = (char *)mem_alloc(dlen);
+    if (!data) return;
+    data[0] = (dptr->flex2) ? '1' : '0';
+    if (dptr->pargs) mem_copy(data + 1, dptr->pargs, dlen - 1);
+    else             data[1] = '\0';
+
+    owa_shmem_desc_put(octx->mapmem, octx->location, dptr->pname, data, dlen);
+    mem_free((void *)data);
+}
+#endif
+
+/*
+** Load one shared describe result into the local cache (mutexed)
+*/
+static void desc_import(owa_context *octx, char *pname, char *data, int dlen)
+{
+    descstruct *dptr;
+    descstruct *optr;
+    char       *sptr;
+    int         flex2;
+    int         plen;
+
+    if ((dlen < 2) || (data[dlen - 1] != '\0')) return;
+    flex2 = (data[0] == '1');
+
+    /* Skip results already held locally */
+    optr = desc_find(octx, pname);
+    if ((optr) && (optr->flex2 == flex2))
+    {
+        if (flex2) return;
+        if (optr->pargs)
+        {
+            for (sptr = optr->pargs; *sptr; sptr += str_length(sptr) + 1);
+            if (mem_compare(optr->pargs, (int)(sptr - optr->pargs),
+                            data + 1, dlen - 2) == 0)
+                return;
+        }
+    }
+
+    plen = str_length(pname) + 1;
+    dptr = (descstruct *)mem_alloc(sizeof(*dptr) + plen + dlen - 1);
+    if (!dptr) return;
+    dptr->pname = ((char *)(void *)dptr) + sizeof(*dptr);
+    mem_copy(dptr->pname, pname, plen);
+    dptr->flex2 = flex2;
+    if (flex2)
+        dptr->pargs = (char *)0;
+    else
+    {
+        dptr->pargs = dptr->pname + plen;
+        mem_copy(dptr->pargs, data + 1, dlen - 1);
+    }
+    desc_store(octx, dptr);
+}
+
+/*
+** Pick up describe results published by other processes.  The
+** generation check is a cheap unlocked read, so this only takes
+** the locks when something new has been published.  If another
+** process has done a CLEARDESCRIBE! since the last check, the local
+** cache is flushed first, since loading only adds entries.  Lock
+** order is always location mutex, then shared memory semaphore.
+*/
+static void desc_sync(owa_context *octx)
+{
+#ifndef NO_FILE_CACHE
+    int gen;
+    int clears;
+
+    if (!(octx->mapmem)) return;
+    if (!(octx->desc_schema)) return;
+    if (*(octx->desc_schema) != '*') return;
+
+    gen = owa_shmem_desc_gen(octx->mapmem);
+    if ((gen < 0) || (gen == octx->desc_gen)) return;
+
+    mowa_acquire_mutex(octx);
+    if (gen != octx->desc_gen)
+    {
+        /* The clear count is bumped before the generation */
+        clears = owa_shmem_desc_clears(octx->mapmem);
+        if (clears != octx->desc_clears)
+        {
+            desc_flush(octx);
+            octx->desc_clears = clears;
+        }
+        owa_shmem_desc_load(octx->mapmem, octx, desc_import);
+        octx->desc_gen = gen;
+    }
+    mowa_release_mutex(octx);
+#endif
+}
+
+/*
+** Describe one procedure from the preload manifest and seed the cache
+** with its collection arguments
+*/
+static int desc_preload_proc(connection *c, owa_context *octx, char *pname)
+{
+    char data[HTBUF_HEADER_MAX];
+    int  dlen;
+
+    if (*pname == '\0') return(0);
+    if (sql_describe_tables(c, pname, data + 1, (int)sizeof(data) - 1) <= 0)
+        return(0); /* Describe failed, or nothing to promote */
+
+    data[0] = '0';
+    for (dlen = 1; data[dlen]; dlen += str_length(data + dlen) + 1);
+    ++dlen;
+
+    mowa_acquire_mutex(octx);
+    desc_import(octx, pname, data, dlen);
+    mowa_release_mutex(octx);
+#ifndef NO_FILE_CACHE
+    owa_shmem_desc_put(octx->mapmem, octx->location, pname, data, dlen);
+#endif
+    return(1);
+}
+
+/*
+** Warm the describe cache from the OwaDescribePreload manifest, so
+** that the first request to a procedure with collection arguments
+** doesn't have to fail, describe, and re-execute.  The manifest is
+** either a SELECT returning procedure names, or a file listing one
+** procedure per line ('#' starts a comment line).  This is run once
+** per process, by the cleanup thread; see owa_desc_preload.
+*/
+static void desc_preload(connection *c, owa_context *octx)
+{
+    char       *sptr;
+#ifndef NO_FILE_CACHE
+    char       *eptr;
+    char       *fbuf;
+    os_objhand  fp;
+    un_long     fsz;
+    un_long     fage;
+#endif
+    int         n;
+    sword       status;
+    char        pname[HTBUF_LINE_LENGTH];
+
+    sptr = octx->desc_preload;
+    while ((*sptr == ' ') || (*sptr == '\t')) ++sptr;
+
+    n = 0;
+    if (!str_compare(sptr, "select", 6, 1))
+    {
+        status = sql_parse(c, c->stmhp3, sptr, -1);
+        if (status == OCI_SUCCESS)
+            status = sql_define(c, c->stmhp3, (ub4)1, (dvoid *)pname,
+                                (sb4)sizeof(pname), (ub2)SQLT_STR, (dvoid *)0);
+        if (status == OCI_SUCCESS)
+            status = sql_exec(c, c->stmhp3, (ub4)0, 0);
+        while (status == OCI_SUCCESS)
+        {
+            status = sql_fetch(c, c->stmhp3, (ub4)1);
+            if (status == OCI_SUCCESS) n += desc_preload_proc(c, octx, pname);
+        }
+    }
+#ifndef NO_FILE_CACHE
+    else
+    {
+        fp = file_open_read(sptr, &fsz, &fage);
+        if (InvalidFile(fp))
+        {
+            debug_out(octx->diagfile,
+                      "Describe preload file [%s] could not be read\n",
+                      sptr, (char *)0, 0, 0);
+            return;
+        }
+        fbuf = (char *)mem_alloc((size_t)fsz + 1);
+        if (fbuf)
+        {
+            n = file_read_data(fp, fbuf, (int)fsz);
+            fbuf[(n > 0) ? n : 0] = '\0';
+            n = 0;
+        }
+        file_close(fp);
+        if (!fbuf) return;
+
+        for (sptr = fbuf; *sptr; sptr = eptr)
+        {
+            for (eptr = sptr; (*eptr) && (*eptr != '\n'); ++eptr);
+            if (*eptr) *(eptr++) = '\0';
+            while ((*sptr == ' ') || (*sptr == '\t')) ++sptr;
+            if (*sptr == '#') continue;
+            str_concat(pname, 0, sptr, (int)sizeof(pname) - 1);
+            for (sptr = pname; *sptr > ' '; ++sptr);
+            *sptr = '\0';
+            n += desc_preload_proc(c, octx, pname);
+        }
+        mem_free((void *)fbuf);
+    }
+#else
+    else
+    {
+        debug_out(octx->diagfile,
+                  "Describe preload file [%s] not supported\n",
+                  sptr, (char *)0, 0, 0);
+        return;
+    }
+#endif
+
+    if (octx->diagflag & DIAG_POOL)
+        debug_out(octx->diagfile, "Describe preload from [%s] cached %d\n",
+                  octx->desc_preload, (char *)0, n, 0);
+}
+
+/*
+** Run the OwaDescribePreload manifest on a pool connection of its own.
+** Called from the cleanup thread, so that no request has to wait for
+** it.  Like pool warming, this is skipped until a request has set up
+** the NLS environment, and for OwaRealm, where every login is a user's.
 */
-static char *set_db_bufsize(char *sptr, int dbchsz)
+void owa_desc_preload(owa_context *octx)
 {
-  switch (dbchsz)
-  {
-  case 2:
-    sptr += str_concat(sptr, 0, "  HTP.HTBUF_LEN := 127;\n", -1);
-    break;
+    connection *c;
+    sword       status;
+    sb4         errinfo;
+    char        errbuf[ERRBUF_SIZE];
 
-  case 3:
-    sptr += str_concat(sptr, 0, "  HTP.HTBUF_LEN := 85;\n", -1);
-    break;
+    if (!(octx->init_complete)) return;
+    if (!(octx->nls_init)) return;
+    if (octx->authrealm) return;
+    if ((!(octx->desc_preload)) || (octx->desc_loaded)) return;
+    if ((!(octx->desc_schema)) || (*(octx->desc_schema) != '*')) return;
 
-  case 4:
-    sptr += str_concat(sptr, 0, "  HTP.HTBUF_LEN := 63;\n", -1);
-    break;
+    if (!mowa_semaphore_get(octx, 0)) return;
 
-  default:
-    break;
-  }
-  return(sptr);
+    /* Prefer an idle connection, or else open a new one */
+    mowa_acquire_mutex(octx);
+    c = octx->c_free.head;
+    if (c)
+    {
+        owa_pool_unlink(octx, c);
+        c->c_lock = C_LOCK_INUSE;
+        os_atomic_add(&(octx->poolstats[C_LOCK_AVAILABLE]), -1);
+        os_atomic_add(&(octx->poolstats[C_LOCK_INUSE]), 1);
+    }
+    else if ((c = octx->c_unused.head))
+    {
+        owa_pool_unlink(octx, c);
+        c->c_lock = C_LOCK_NEW;
+        c->slotnum = (int)(c - octx->c_pool);
+        os_atomic_add(&(octx->poolstats[C_LOCK_UNUSED]), -1);
+        os_atomic_add(&(octx->poolstats[C_LOCK_INUSE]), 1);
+    }
+    mowa_release_mutex(octx);
+
+    /* Pool is busy; try again on the next wakeup */
+    if (!c)
+    {
+        mowa_semaphore_put(octx);
+        return;
+    }
+
+    *errbuf = '\0';
+    c->errbuf = errbuf;
+    status = OCI_SUCCESS;
+    if (c->c_lock == C_LOCK_NEW)
+    {
+        status = sql_connect(c, octx, (char *)0, (char *)0, &errinfo);
+        if (status == OCI_SUCCESS)
+        {
+            sql_set_nls(c, octx);
+            c->c_lock = C_LOCK_INUSE;
+        }
+        else
+            sql_disconnect(c);
+    }
+    if (status == OCI_SUCCESS)
+    {
+        octx->desc_loaded = 1;
+        desc_preload(c, octx);
+    }
+    c->errbuf = (char *)0;
+
+    unlock_connection(octx, c);
 }
 
 /*
@@ -491,6 +1337,7 @@ static void cache_describe(owa_context *octx, char *pname, int nargs,
     char         *sptr;
     char         *dname;
     char         *schema;
+    int           dslot;
 
     /* Caching only enabled if the DESCRIBE schema is set to "*" */
     schema = octx->desc_schema;
@@ -498,12 +1345,16 @@ static void cache_describe(owa_context *octx, char *pname, int nargs,
     if (*schema != '*') return;
 
     /* See if procedure name is already in the cache */
-    for (optr = octx->desc_cache; optr != (descstruct *)0; optr = optr->next)
-        if (str_compare(optr->pname, pname, -1, 1) == 0)
-            break;
+    desc_sync(octx);
+    dslot = desc_enter(octx);
+    optr = desc_find(octx, pname);
 
     /* If already in cache skip any further processing of flexargs */
-    if ((optr) && (nargs == 0)) return;
+    if ((optr) && (nargs == 0))
+    {
+        desc_leave(octx, dslot);
+        return;
+    }
 
     pnamelen = str_length(pname) + 2;
 
@@ -512,7 +1363,10 @@ static void cache_describe(owa_context *octx, char *pname, int nargs,
     for (i = 0; i < nargs; ++i)
     {
         if (counts[i] == LONG_MAXSZ)
+        {
+            desc_leave(octx, dslot);
             return; /* Don't cache relaxed describes */
+        }
         if ((counts[i] > 0) && (names[i]))
         {
             pnamelen += (str_length(names[i]) + 1);
@@ -532,7 +1386,11 @@ static void cache_describe(owa_context *octx, char *pname, int nargs,
     }
 
     /* If cache already up-to-date, done */
-    if (!newflag) return;
+    if (!newflag)
+    {
+        desc_leave(octx, dslot);
+        return;
+    }
 
     /* Merge arguments from previous calls */
     if (optr)
@@ -607,15 +1465,17 @@ static void cache_describe(owa_context *octx, char *pname, int nargs,
 
             *dname = '\0'; /* Terminator */
         }
+    }
+    desc_leave(octx, dslot);
 
-        /* Add to describe cache */
+    /* Add to describe cache, replacing the prior entry */
+    if (dptr)
+    {
+#ifndef NO_FILE_CACHE
+        if (octx->mapmem) desc_publish(octx, dptr);
+#endif
         mowa_acquire_mutex(octx);
-        {
-          owa_context * volatile optr = octx;
-          /* ### This should use a compare-and-swap ### */
-          dptr->next = optr->desc_cache;
-          optr->desc_cache = dptr;
-        }
+        desc_store(octx, dptr);
         mowa_release_mutex(octx);
     }
 }
@@ -873,13 +1733,29 @@ static void debug_status(owa_context *octx, char *pidstr,
 ** If a session is specified, preferentially look for a matching connection
 ** Print diagnostic information
 */
-static connection *get_connection(owa_context *octx, char *session)
+static connection *get_connection(owa_context *octx, char *session,
+                                  int *shed)
 {
     connection *c;
     char       *sptr;
     int         i;
 
-    c = lock_connection(octx, session);
+    /*
+    ** The admission queue needs the pool latch, so threaded workers
+    ** only.  Requests only join it when the pool is exhausted; if no
+    ** one is in line, first try for a connection without waiting.
+    */
+    *shed = 0;
+    if ((octx->q_limit > 0) && (octx->multithread))
+    {
+        c = (connection *)0;
+        if (octx->q_tail == octx->q_head)
+            c = lock_connection(octx, session, 0);
+        if (!c)
+            c = queue_connection(octx, session, shed);
+    }
+    else
+        c = lock_connection(octx, session, octx->pool_wait_ms);
     if (octx->diagflag & DIAG_POOL)
     {
         if (!c)
@@ -920,6 +1796,19 @@ static connection *get_connection(owa_context *octx, char *session)
         }
     }
 
+    /*
+    ** Run a deferred package reset the cleanup thread didn't get to;
+    ** if it fails, drop the connection so that a new one is made.
+    */
+    if (c)
+      if (c->reset_due)
+      {
+          c->reset_due = 0;
+          c->errbuf = (char *)0;
+          if (owa_reset(c, octx) != OCI_SUCCESS)
+              sql_disconnect(c);
+      }
+
     /* Allocate permanent buffer for socket maintenance */
     if (c)
       if ((octx->altflags & ALT_MODE_LOGGING) && (!(c->sockctx)))
@@ -965,8 +1854,23 @@ static int put_connection(owa_context *octx, int status, char *pidstr,
         if ((c->c_lock == C_LOCK_INUSE) && (pidstr))
         {
             if (status != OCI_SUCCESS) c->errbuf = (char *)0;
-            cstatus = owa_reset(c, octx);
-            debug_sql(octx, "reset", pidstr, cstatus, (char *)0);
+            /*
+            ** The response has already been flushed; if there's a
+            ** cleanup thread, let it run the reset so that this worker
+            ** is free right away.  Not done for session-matched pools,
+            ** where the slot has to stay findable by its session.
+            */
+            if (!(octx->altflags & ALT_MODE_KEEP) && !(octx->authrealm) &&
+                !(octx->session) && (mowa_reset_async(octx)))
+            {
+                c->c_lock = C_LOCK_RESET;
+                debug_sql(octx, "defer reset", pidstr, cstatus, (char *)0);
+            }
+            else
+            {
+                cstatus = owa_reset(c, octx);
+                debug_sql(octx, "reset", pidstr, cstatus, (char *)0);
+            }
         }
 #endif
         c->mem_err = 0;
@@ -986,6 +1890,8 @@ static int put_connection(owa_context *octx, int status, char *pidstr,
 **   SHOWPOOL!     - Show status of OCI connection pool
 **   CLEARCACHE!   - Clear file system cache
 **   SHOWCACHE!    - Show status of file system cache
+**   CLEARDESCRIBE! - Clear describe cache
+**   SHOWDESCRIBE! - Show contents of describe cache
 **   AUTHENTICATE! - Force authorization check
 */
 static int handle_control(owa_context *octx, request_rec *r,
@@ -996,6 +1902,8 @@ static int handle_control(owa_context *octx, request_rec *r,
     char       *aptr;
     int         i, n;
     int         poolstats[C_LOCK_MAXIMUM];
+    int         qstats[QSTAT_SIZE];
+    un_long     hits, misses;
     sword       status;
     connection *c;
     connection  cdefault;
@@ -1066,7 +1974,7 @@ static int handle_control(owa_context *octx, request_rec *r,
     {
         do
         {
-            c = lock_connection(octx, (char *)0);
+            c = lock_connection(octx, (char *)0, octx->pool_wait_ms);
             if (c)
             {
                 status = OCI_SUCCESS;
@@ -1097,14 +2005,18 @@ static int handle_control(owa_context *octx, request_rec *r,
         n = 0;
         for (i = 0; i < octx->poolsize; ++i)
             if (octx->c_pool[i].c_lock == C_LOCK_OFFLINE) ++n;
-        octx->poolstats[C_LOCK_OFFLINE] -= n;
-        octx->poolstats[C_LOCK_UNUSED] += n;
+        os_atomic_add(&(octx->poolstats[C_LOCK_OFFLINE]), -n);
+        os_atomic_add(&(octx->poolstats[C_LOCK_UNUSED]), n);
         owa_shmem_update(octx->mapmem, &(octx->shm_offset),
                          octx->realpid, octx->location, octx->poolstats);
-        for (i = 0; i < octx->poolsize; ++i)
+        for (i = octx->poolsize - 1; i >= 0; --i)
         {
             c = octx->c_pool + i;
-            if (c->c_lock == C_LOCK_OFFLINE) c->c_lock = C_LOCK_UNUSED;
+            if (c->c_lock == C_LOCK_OFFLINE)
+            {
+                c->c_lock = C_LOCK_UNUSED;
+                owa_pool_link(octx, c);
+            }
         }
         mowa_release_mutex(octx);
         /* Fall through to showpool */
@@ -1129,6 +2041,16 @@ static int handle_control(owa_context *octx, request_rec *r,
 #endif
         return(OK);
     }
+    else if ((!str_compare(spath, "CLEARDESCRIBE!", -1, 1)) ||
+             (!str_compare(spath, "SHOWDESCRIBE!", -1, 1)))
+    {
+        if (!str_compare(spath, "CLEARDESCRIBE!", -1, 1))
+            desc_clear(octx);
+        htp_error(r, "DESCRIBE CACHE");
+        desc_show(octx, r);
+        htp_error(r, (char *)0);
+        return(OK);
+    }
     else if (str_compare(spath, "SHOWPOOL!", -1, 1))
     {
         /* Generate page showing available commands */
@@ -1150,6 +2072,10 @@ static int handle_control(owa_context *octx, request_rec *r,
         morq_print_str(r, aptr, "Remove old files from file system cache");
         morq_print_str(r, sptr, "SHOWCACHE!");
         morq_print_str(r, aptr, "Show files in file system cache");
+        morq_print_str(r, sptr, "CLEARDESCRIBE!");
+        morq_print_str(r, aptr, "Empty the describe cache");
+        morq_print_str(r, sptr, "SHOWDESCRIBE!");
+        morq_print_str(r, aptr, "Show procedures in describe cache");
         morq_print_str(r, sptr, "AUTHENTICATE!");
         morq_print_str(r, aptr, "Force authorization check");
         morq_write(r, "</table>\n", -1);
@@ -1162,13 +2088,15 @@ static int handle_control(owa_context *octx, request_rec *r,
 
     morq_print_str(r, "<p>PID = %s</p>\n", pid);
 
-    if (owa_shmem_stats(octx->mapmem, octx->location, poolstats) > 0)
+    if (owa_shmem_stats(octx->mapmem, octx->location,
+                        poolstats, qstats) > 0)
     {
         n = 0;
         for (i = 0; i < C_LOCK_MAXIMUM; ++i) n += poolstats[i];
     }
     else
     {
+        for (i = 0; i < QSTAT_SIZE; ++i) qstats[i] = octx->qstats[i];
         for (i = 0; i < C_LOCK_MAXIMUM; ++i) poolstats[i] = 0;
         for (i = 0; i < octx->poolsize; ++i)
         {
@@ -1198,6 +2126,8 @@ static int handle_control(owa_context *octx, request_rec *r,
     morq_print_int(r, aptr, poolstats[C_LOCK_INUSE]);
     morq_print_str(r, sptr, "Offline:");
     morq_print_int(r, aptr, poolstats[C_LOCK_OFFLINE]);
+    morq_print_str(r, sptr, "Resetting:");
+    morq_print_int(r, aptr, poolstats[C_LOCK_RESET]);
     morq_print_str(r, sptr, "Unknown:");
     morq_print_int(r, aptr, poolstats[C_LOCK_UNKNOWN]);
 
@@ -1206,6 +2136,59 @@ static int handle_control(owa_context *octx, request_rec *r,
     morq_print_str(r, sptr, "Total:");
     morq_print_int(r, aptr, n);
 
+    if (octx->q_limit > 0)
+    {
+        morq_write(r, "<tr><td colspan=\"2\">&nbsp;</td></tr>\n", -1);
+
+        morq_print_str(r, sptr, "Queued:");
+        morq_print_int(r, aptr, qstats[QSTAT_DEPTH]);
+        morq_print_str(r, sptr, "Turned away:");
+        morq_print_int(r, aptr, qstats[QSTAT_SHED]);
+        morq_print_str(r, sptr, "Queue wait 50%:");
+        morq_print_int(r, "<td>&lt; %d ms</td></tr>\n",
+                       queue_percentile(qstats, 50));
+        morq_print_str(r, sptr, "Queue wait 90%:");
+        morq_print_int(r, "<td>&lt; %d ms</td></tr>\n",
+                       queue_percentile(qstats, 90));
+        morq_print_str(r, sptr, "Queue wait 99%:");
+        morq_print_int(r, "<td>&lt; %d ms</td></tr>\n",
+                       queue_percentile(qstats, 99));
+    }
+
+    /* Session affinity counters are local to this process */
+    if (octx->session)
+    {
+        morq_write(r, "<tr><td colspan=\"2\">&nbsp;</td></tr>\n", -1);
+
+        morq_print_str(r, sptr, "Session lookups:");
+        morq_print_int(r, aptr, (int)octx->sess_lookups);
+        morq_print_str(r, sptr, "Session matches:");
+        morq_print_int(r, aptr, (int)octx->sess_hits);
+        morq_print_str(r, sptr, "Session evictions:");
+        morq_print_int(r, aptr, (int)octx->sess_evicts);
+    }
+
+    /* Statement cache counters are local to this process */
+    if (octx->stmt_cache > 0)
+    {
+        hits = misses = 0;
+        for (i = 0; i < octx->poolsize; ++i)
+        {
+            c = octx->c_pool + i;
+            hits += c->stmt_hits;
+            misses += c->stmt_misses;
+        }
+
+        morq_write(r, "<tr><td colspan=\"2\">&nbsp;</td></tr>\n", -1);
+
+        morq_print_str(r, sptr, "Statement cache size:");
+        morq_print_int(r, aptr, octx->stmt_cache);
+        morq_print_str(r, sptr, "Statement cache hits:");
+        morq_print_int(r, aptr, (int)hits);
+        morq_print_str(r, sptr, "Statement cache misses:");
+        morq_print_int(r, aptr, (int)misses);
+    }
+
     morq_write(r, "</table>\n", -1);
 
     htp_error(r, (char *)0);
@@ -1969,38 +2952,180 @@ static int search_env(owa_context *octx, request_rec *r,
 }
 
 /*
-** Transfer environment variables to OCI-compatible buffers
+** Point the environment record at the environment variables.  They're
+** bound by pointer, so only the actual lengths go to the database;
+** the few strings too long for the bind widths are truncated copies.
 */
-static void transfer_env(request_rec *r, env_record *senv, un_long ipaddr,
-                         int nwidth, int vwidth, int nenv, char *outbuf)
+static int transfer_env(request_rec *r, env_record *senv, un_long ipaddr,
+                        int nwidth, int vwidth, int nenv, char **ptrs)
 {
-    char *names, *values;
     char *nptr,  *vptr;
+    char *sptr;
     int   i;
 
-    names = outbuf;
-    values = outbuf + (nenv * nwidth);
     senv->count = nenv;
-    senv->names = names;
-    senv->values = values;
+    senv->names = ptrs;
+    senv->values = ptrs + nenv;
     senv->nwidth = nwidth;
     senv->vwidth = vwidth;
     for (i = 0; i < nenv; ++i)
     {
         morq_table_get(r, OWA_TABLE_SUBPROC, i, &nptr, &vptr);
-        str_concat(names, 0, nptr, nwidth - 1);
-        str_concat(values, 0, vptr, vwidth - 1);
-        names += nwidth;
-        values += vwidth;
+        if (str_length(nptr) >= nwidth)
+        {
+            sptr = (char *)morq_alloc(r, (size_t)nwidth, 0);
+            if (!sptr) return(-nwidth);
+            str_concat(sptr, 0, nptr, nwidth - 1);
+            nptr = sptr;
+        }
+        if (str_length(vptr) >= vwidth)
+        {
+            sptr = (char *)morq_alloc(r, (size_t)vwidth, 0);
+            if (!sptr) return(-vwidth);
+            str_concat(sptr, 0, vptr, vwidth - 1);
+            vptr = sptr;
+        }
+        senv->names[i] = nptr;
+        senv->values[i] = vptr;
     }
     senv->ipaddr = ipaddr;
+    return(0);
+}
+
+#ifdef OWA_SPILL_ARGS
+/*
+** Spill a POST body to a temporary file in the OwaSpill directory,
+** starting with the nread bytes already in buf (if any), and return
+** a writable mapping of the file in place of an arena block.  Pages
+** of the mapping are backed by the file, so the OS can write them
+** out under memory pressure instead of holding the whole body in
+** the worker's heap.  The file is unlinked as soon as it's mapped;
+** the mapping keeps the pages until owa_free_args releases it.
+*/
+static char *spill_arguments(owa_context *octx, request_rec *r,
+                             owa_request *owa_req, char *buf,
+                             long_64 nread, long_64 *clen)
+{
+    os_objhand  fp;
+    os_objhand  hnd;
+    char       *args = (char *)0;
+    char       *tempname;
+    char       *fpath;
+    long_64     bsize;
+    long_64     i;
+    un_long     fsz;
+    un_long     fage;
+    long        rsize;
+    int         n;
+
+    if (buf)
+        bsize = nread;
+    else
+    {
+        bsize = HTBUF_BLOCK_READ;
+        buf = (char *)morq_alloc(r, (size_t)bsize, 0);
+        if (!buf) goto spillerr;
+    }
+
+    fpath = (char *)morq_alloc(r, HTBUF_HEADER_MAX * 2, 0);
+    if (!fpath) goto spillerr;
+    tempname = fpath + HTBUF_HEADER_MAX;
+
+    /* file_open_temp wants a file path; it uses only the directory */
+    n = str_concat(fpath, 0, octx->spilldir, HTBUF_HEADER_MAX - 8);
+    if ((n > 0) && (fpath[n - 1] != os_dir_separator))
+        fpath[n++] = os_dir_separator;
+    str_copy(fpath + n, "owa");
+
+    fp = file_open_temp(fpath, tempname, HTBUF_HEADER_MAX);
+    if (InvalidFile(fp)) goto spillerr;
+
+    /* Copy out the part already read, then stream the rest */
+    if (nread > 0)
+        if (file_write_data(fp, buf, (int)nread) != (int)nread)
+            goto spillclose;
+    for (i = nread; i < *clen; i += n)
+    {
+        rsize = ((*clen - i) < bsize) ? (long)(*clen - i) : (long)bsize;
+        n = morq_read(r, buf, rsize);
+        if (n <= 0) break;
+        if (file_write_data(fp, buf, n) != n) goto spillclose;
+    }
+    /* Null-terminate the body on disk, as the arena copy would be */
+    if (file_write_data(fp, "", 1) != 1) goto spillclose;
+
+    *clen = i;
+    fsz = (un_long)(i + 1);
+
+    hnd = file_map(fp, fsz, (char *)0, 1);
+    args = (char *)file_view(hnd, fsz, 1);
+    file_close(fp);
+
+    if (args)
+    {
+        owa_req->post_map = args;
+        owa_req->post_size = fsz;
+        owa_req->post_hnd = hnd;
+    }
+    else
+    {
+        /* If it can't be mapped, read it back into one arena block */
+        file_unmap(hnd, (void *)0, (un_long)0);
+        fp = file_open_read(tempname, &fsz, &fage);
+        if (!InvalidFile(fp))
+        {
+            args = (char *)morq_alloc(r, (size_t)(i + 1), 0);
+            if (args)
+            {
+                for (nread = 0; nread <= i; nread += n)
+                {
+                    bsize = (i + 1) - nread;
+                    if (bsize > HTBUF_BLOCK_READ) bsize = HTBUF_BLOCK_READ;
+                    n = file_read_data(fp, args + nread, (int)bsize);
+                    if (n <= 0) break;
+                }
+                args[i] = '\0';
+            }
+            file_close(fp);
+        }
+    }
+    file_delete(tempname);
+    if (!args) goto spillerr;
+    return(args);
+
+spillclose:
+    file_close(fp);
+    file_delete(tempname);
+spillerr:
+    *clen = -(HTBUF_BLOCK_READ);
+    return((char *)0);
+}
+#endif
+
+/*
+** Release a POST body spilled to a temporary file
+*/
+void owa_free_args(owa_request *owa_req)
+{
+#ifdef OWA_SPILL_ARGS
+    if (owa_req->post_map)
+        file_unmap(owa_req->post_hnd, (void *)(owa_req->post_map),
+                   owa_req->post_size);
+#endif
+    owa_req->post_map = (char *)0;
 }
 
 /*
 ** Get arguments from stream
 ** ### SHOULD HANDLE "chunked" REQUESTS WITHOUT CONTENT LENGTHS ###
+**
+** Bodies of known length are read into a single arena block.  With
+** OwaSpill, a body larger than the threshold, or one of unknown
+** length that would grow past it, is spilled to a mapped temp file
+** instead of being doubled and copied in memory.
 */
-static char *get_arguments(owa_context *octx, request_rec *r, long_64 *clen)
+static char *get_arguments(owa_context *octx, request_rec *r, long_64 *clen,
+                           owa_request *owa_req)
 {
     char    *args;
     char    *sptr;
@@ -2015,6 +3140,10 @@ static char *get_arguments(owa_context *octx, request_rec *r, long_64 *clen)
     {
         if ((octx->upmax > 0) && (*clen > octx->upmax)) *clen = octx->upmax;
         bsize = *clen;
+#ifdef OWA_SPILL_ARGS
+        if ((octx->spillsize > 0) && (bsize > octx->spillsize))
+            return(spill_arguments(octx, r, owa_req, (char *)0, 0, clen));
+#endif
     }
     else /* Content length is unknown */
     {
@@ -2027,6 +3156,10 @@ static char *get_arguments(owa_context *octx, request_rec *r, long_64 *clen)
     {
         if (i == bsize)
         {
+#ifdef OWA_SPILL_ARGS
+            if ((octx->spillsize > 0) && ((bsize + bsize) > octx->spillsize))
+                return(spill_arguments(octx, r, owa_req, args, i, clen));
+#endif
             sptr = args;
             bsize += bsize;
             args = (char *)morq_alloc(r, (size_t)(bsize + 1), 0);
@@ -2082,6 +3215,7 @@ static int parse_stream(request_rec *r, owa_context *octx, char *outbuf,
 {
     long_64 n;
     int   blen;
+    mem_pattern bpat;
     char *aptr;
     char *sptr;
     char *optr;
@@ -2092,13 +3226,14 @@ static int parse_stream(request_rec *r, owa_context *octx, char *outbuf,
     int   nparams = argrec->nargs;
 
     blen = str_length(boundary);
+    mem_pattern_init(&bpat, boundary, blen);
 
     optr = outbuf;
     n = clen + 2;
 
     while (n > 0)
     {
-        sptr = mem_find(optr, n, boundary, blen);
+        sptr = mem_scan(&bpat, optr, n);
         if (sptr != optr)
           break; /* ### Error - boundary not at beginning */
         if (n < (long_64)blen)
@@ -2178,7 +3313,7 @@ static int parse_stream(request_rec *r, owa_context *octx, char *outbuf,
         n -= (long_64)(sptr - optr);
         optr = sptr;
 
-        sptr = mem_find(optr, n, boundary, blen);
+        sptr = mem_scan(&bpat, optr, n);
         if (!sptr)
             sptr = optr + n; /* ### boundary not found */
         else if ((sptr - optr) + blen > n)
@@ -2248,96 +3383,6 @@ static int parse_string(request_rec *r, char *args, http_args *argrec)
 }
 #endif
 
-/*
-** Convert multi-valued arguments to collection form
-*/
-static int collect_args(request_rec *r, int *nargs, file_arg *filelist,
-                        char **param_name, char **param_value,
-                        char ***param_array, ub4 *param_count)
-{
-    int i, j, n, m;
-    file_arg *afile;
-
-    /* If there's 0 or 1 argument, nothing to do */
-    n = *nargs;
-    if (n <= 1) return(0);
-
-    /* Go through all arguments starting with the second argument */
-    for (i = 1; i < n; ++i)
-    {
-      /* Compare its name to all previous arguments */
-      for (j = 0; j < i; ++j)
-        if (param_name[i])
-          if (!str_compare(param_name[i], param_name[j], -1, 1))
-            break;
-
-      /* If it matched, then it should be a collection binding */
-      if (j < i)
-      {
-        /* If this is the first duplicate, convert the original to collection */
-        if (param_value[j] != (char *)0)
-        {
-          m = sizeof(char *) * HTBUF_PARAM_CHUNK;
-          param_array[j] = (char **)morq_alloc(r, m, 0);
-          if (!param_array[j]) return(-m);
-          param_array[j][0] = param_value[j];
-          param_value[j] = (char *)0;
-        }
-        /* Otherwise, resize the collection if necessary */
-        if ((param_count[j] & (HTBUF_PARAM_CHUNK-1)) == 0)
-        {
-            int nz = param_count[j];
-            param_array[j] = (char **)resize_arr(r, (void *)param_array[j],
-                                                 sizeof(char *), nz);
-            nz += HTBUF_PARAM_CHUNK;
-            if (!param_array[j]) return(-((int)(nz * sizeof(char *))));
-        }
-        /* Move the duplicate value into the collection */
-        param_array[j][param_count[j]++] = param_value[i];
-        /* Mark the duplicate as unused */
-        param_name[i] = (char *)0;
-        /*
-        ** ### If it's a file argument, blindly fix up the location.
-        ** ### This assumes all duplicate file arguments are sequential.
-        */
-        if (filelist)
-        {
-          int basepos = filelist->param_num;
-          for (afile = filelist; afile; afile = afile->next)
-          {
-            if (afile->param_num == i)
-            {
-              afile->param_num = basepos;
-              break;
-            }
-            basepos = afile->param_num;
-          }
-        }
-      }
-    }
-
-    /* Shift values to remove the "holes" */
-    for (i = j = 0; i < n; ++i)
-    {
-        if (param_name[i])
-        {
-          if (j < i)
-          {
-            param_name[j] = param_name[i];
-            param_value[j] = param_value[i];
-            param_array[j] = param_array[i];
-            param_count[j] = param_count[i];
-            for (afile = filelist; afile; afile = afile->next)
-              if (afile->param_num == i) afile->param_num = j;
-          }
-          ++j;
-        }
-    }
-    *nargs = j;
-
-    return(0);
-}
-
 /*
 ** Append a body as a file-like parameter
 */
@@ -2363,7 +3408,7 @@ static int append_body(request_rec *r, int dad_csid,
         *pvalues = (char **)resize_arr(r, (void *)(*pvalues),
                                        sizeof(char *), nparams);
         if (!(*pnames) || !(*pvalues)) return(-1);
-        *arrsz += HTBUF_PARAM_CHUNK;
+        *arrsz += ARR_GROWTH(*arrsz);
       }
 
       (*pnames)[nparams] = "MODOWA$REST_PATH";
@@ -2411,7 +3456,7 @@ static int append_body(request_rec *r, int dad_csid,
         *pvalues = (char **)resize_arr(r, (void *)(*pvalues),
                                        sizeof(char *), nparams);
         if (!(*pnames) || !(*pvalues)) return(-1);
-        *arrsz += HTBUF_PARAM_CHUNK;
+        *arrsz += ARR_GROWTH(*arrsz);
       }
 
       /* Fake field name (must be PL/SQL compatible) */
@@ -2439,6 +3484,7 @@ static int parse_args(request_rec *r, owa_context *octx, int call_mode,
     int            strip_mode = ((octx->doc_table) || (octx->doc_column));
     int            j, n;
     int            blen;
+    mem_pattern    bpat;
     long_64        bufsz;
     long_64        offset;
     char          *aptr;
@@ -2452,6 +3498,7 @@ static int parse_args(request_rec *r, owa_context *octx, int call_mode,
     file_arg      *prevfile = (file_arg *)0;
 
     blen = str_length(boundary);
+    mem_pattern_init(&bpat, boundary, blen);
 
     bufsz = (clen > 0) ? clen : (long_64)HTBUF_BLOCK_SIZE;
     bufsz += 2;
@@ -2504,7 +3551,7 @@ static int parse_args(request_rec *r, owa_context *octx, int call_mode,
 
     while (bufsz > 0)
     {
-        sptr = mem_find(outbuf, bufsz, boundary, blen);
+        sptr = mem_scan(&bpat, outbuf, bufsz);
         if (sptr != outbuf)
           break; /* ### Error - boundary not at beginning */
         if (bufsz < (long_64)blen)
@@ -2589,7 +3636,7 @@ static int parse_args(request_rec *r, owa_context *octx, int call_mode,
         /*
         ** Data until next boundary is content for this field
         */
-        aptr = mem_find(sptr, bufsz - (long_64)j, boundary, blen);
+        aptr = mem_scan(&bpat, sptr, bufsz - (long_64)j);
         if (!aptr) break; /* Error - field item too large */
 
         /* Temporarily offset is the distance between pointers */
@@ -2669,7 +3716,7 @@ static int parse_args(request_rec *r, owa_context *octx, int call_mode,
               *pvalues = (char **)resize_arr(r, (void *)(*pvalues),
                                              sizeof(char *), nparams);
               if (!(*pnames) || !(*pvalues)) return(-1);
-              *arrsz += HTBUF_PARAM_CHUNK;
+              *arrsz += ARR_GROWTH(*arrsz);
             }
 
             (*pnames)[nparams] = pname;
@@ -2687,7 +3734,7 @@ static int parse_args(request_rec *r, owa_context *octx, int call_mode,
             *pvalues = (char **)resize_arr(r, (void *)(*pvalues),
                                            sizeof(char *), nparams);
             if (!(*pnames) || !(*pvalues)) return(-1);
-            *arrsz += HTBUF_PARAM_CHUNK;
+            *arrsz += ARR_GROWTH(*arrsz);
           }
 
           (*pnames)[nparams] = fldname;
@@ -2798,7 +3845,6 @@ int owa_handle_request(owa_context *octx, request_rec *r,
     int           fargs;
     int           zero_args = 0;
     int           osize;
-    int           esize;
     int           file_flag;
     int           long_flag;
     int           wpg_flag = 0;
@@ -2808,6 +3854,7 @@ int owa_handle_request(owa_context *octx, request_rec *r,
     int           bound_flag = 0;
     int           realm_flag = 0;
     int           nopool_flag = 0;
+    int           shed;
     int           desc_mode;
 #ifndef NO_FILE_CACHE
     ub4           life;
@@ -2819,6 +3866,9 @@ int owa_handle_request(owa_context *octx, request_rec *r,
     char          pcount[LONG_MAXSTRLEN];
     char         *outbuf;
     char         *stmt = (char *)0;
+    char         *fstmt = (char *)0;
+    char        **envptrs;
+    int           fsize;
     char         *spath;
     char         *fpath;
     char         *args;
@@ -2858,10 +3908,14 @@ int owa_handle_request(owa_context *octx, request_rec *r,
     char        **pvalues = (char **)0;
     int           cs_id;
     int           makeutf = 0;
+    int           colsz = HTBUF_PARAM_CHUNK;
+    arg_index     argx;
+    un_long       argh = 0;
     int           wdb_realm_logout = 0;
     int           append_timestamp = 0;
     long_64       stime;
     descstruct   *dptr;
+    int           dslot;
     char         *ctype = (char *)0;
     char         *post_body = (char *)0;
     char         *rest_path = (char *)0;
@@ -3187,19 +4241,13 @@ checkflex:
         /* Also, check the describe cache */
         if (call_mode != 3)
         {
-            for (dptr = octx->desc_cache;
-                 dptr != (descstruct *)0;
-                 dptr = dptr->next)
-            {
-                if (str_compare(dptr->pname, spath, -1, 1) == 0)
-                {
-                    if (dptr->flex2)
-                    {
-                        call_mode = 3;
-                        break;
-                    }
-                }
-            }
+            desc_sync(octx);
+            dslot = desc_enter(octx);
+            dptr = desc_find(octx, spath);
+            if (dptr)
+                if (dptr->flex2)
+                    call_mode = 3;
+            desc_leave(octx, dslot);
         }
         /* Convert multipart/form-data calls if necessary */
         if (file_flag)
@@ -3260,7 +4308,7 @@ checkflex:
         /* Retrieve the body */
         morq_stream(r, 0);
         if (deferred_read) args = "";
-        else               args = get_arguments(octx, r, &clen);
+        else               args = get_arguments(octx, r, &clen, owa_req);
         if (!args) return(mem_error(r, (int)(-clen), diagflag));
         if (octx->altflags & ALT_MODE_NOMERGE) req_args = (char *)0;
     }
@@ -3280,7 +4328,7 @@ checkflex:
         morq_stream(r, 0);
 
         if (deferred_read) args = "";
-        else               args = get_arguments(octx, r, &clen);
+        else               args = get_arguments(octx, r, &clen, owa_req);
 
         if (!args) return(mem_error(r, (int)(-clen), diagflag));
     }
@@ -3292,7 +4340,7 @@ checkflex:
     {
         /* Treat the body in the same manner as a POST */
         morq_stream(r, 0);
-        args = get_arguments(octx, r, &clen);
+        args = get_arguments(octx, r, &clen, owa_req);
         if (!args) return(mem_error(r, (int)(-clen), diagflag));
     }
     if (spath == octx->doc_start)
@@ -3445,6 +4493,7 @@ checkflex:
     /*
     ** Parse argument names and values from the argument string
     */
+    argx_start(r, &argx);
     for (adx = 0; adx < 2; ++adx)
     {
       args = arg_strs[adx];
@@ -3478,16 +4527,16 @@ checkflex:
 #endif
 
             /* Look for a parameter name to match this one */
-            for (n = 0; n < nargs; ++n)
-                if (!str_compare(param_name[n], aptr, -1, 1))
-                    break;
+            argh = str_hash(aptr, -1, 1);
+            n = argx_find(&argx, param_name, aptr, argh);
+            if (n < 0) n = nargs;
         }
         if (n == nargs)
         {
             if (nargs == arrsz)
             {
                 /* Reallocate arrays */
-                arrsz += HTBUF_PARAM_CHUNK;
+                arrsz += ARR_GROWTH(arrsz);
 
                 param_name = (char **)resize_arr(r, (void *)param_name,
                                                  sizeof(char *), nargs);
@@ -3506,9 +4555,15 @@ checkflex:
                                                     sizeof(ub4), nargs);
                     if (!param_count)
                       return(mem_error(r, arrsz * sizeof(ub4), diagflag));
+                    colsz = arrsz;
                 }
             }
             param_name[n] = aptr;
+            if ((call_mode != 1) && (call_mode != 3))
+            {
+                m = argx_add(&argx, n, argh);
+                if (m < 0) return(mem_error(r, m, diagflag));
+            }
         }
 
         aptr = morq_getword(r, (const char **)&args, '&', 1);
@@ -3572,7 +4627,7 @@ checkflex:
                     if (++nargs == arrsz)
                     {
                       /* Reallocate name/value arrays */
-                      arrsz += HTBUF_PARAM_CHUNK;
+                      arrsz += ARR_GROWTH(arrsz);
 
                       param_name = (char **)resize_arr(r, (void *)param_name,
                                                        sizeof(char *), nargs);
@@ -3608,12 +4663,12 @@ checkflex:
                 param_value[n] = (char *)0;
                 param_count[n] = 1;
             }
-            if ((param_count[n] & (HTBUF_PARAM_CHUNK-1)) == 0)
+            if (ARR_FULL(param_count[n]))
             {
                 int nz = param_count[n];
                 param_array[n] = (char **)resize_arr(r, (void *)param_array[n],
                                                      sizeof(char *), nz);
-                nz += HTBUF_PARAM_CHUNK;
+                nz += ARR_GROWTH(nz);
                 if (!param_array[n])
                   return(mem_error(r, nz * sizeof(char *), diagflag));
             }
@@ -3649,26 +4704,35 @@ checkflex:
         /* Add space for bind variable names and quoted identifiers */
         stmtlen += (12 * nargs);
 
-        /* If necessary, resize the collection arrays */
-        for (i = HTBUF_PARAM_CHUNK; i < arrsz; i += HTBUF_PARAM_CHUNK)
+        /* If necessary, resize the collection arrays (in one step) */
+        if (arrsz > colsz)
         {
-            param_array = (char ***)resize_arr(r, (void *)param_array,
-                                               sizeof(char **), i);
-            if (!param_array)
-              return(mem_error(r, i * sizeof(char **), diagflag));
-            param_count = (ub4 *)resize_arr(r, (void *)param_count,
-                                            sizeof(ub4), i);
-            if (!param_count)
-              return(mem_error(r, i * sizeof(ub4), diagflag));
+            char ***new_array;
+            ub4    *new_count;
+
+            m = arrsz * sizeof(char **);
+            new_array = (char ***)morq_alloc(r, m, 1);
+            if (!new_array) return(mem_error(r, m, diagflag));
+            mem_copy(new_array, param_array, colsz * sizeof(char **));
+            param_array = new_array;
+            m = arrsz * sizeof(ub4);
+            new_count = (ub4 *)morq_alloc(r, m, 1);
+            if (!new_count) return(mem_error(r, m, diagflag));
+            mem_copy(new_count, param_count, colsz * sizeof(ub4));
+            param_count = new_count;
+            colsz = arrsz;
         }
 
-        for (j = 0; j < nargs; ++j) param_count[j] = 1;
+        /* Keep the counts of collections built from the query string */
+        j = ((call_mode == 1) || (call_mode == 3)) ? 0 : fargs;
+        for (; j < nargs; ++j) param_count[j] = 1;
 
         /* If not a flex-args call, convert collection arguments */
         if (call_mode == 0)
         {
           /* Convert repeated arguments to collection bindings */
-          m = collect_args(r, &nargs, filelist,
+          argx_start(r, &argx);
+          m = argx_collect(&argx, &nargs, filelist,
                            param_name, param_value, param_array, param_count);
         }
     }
@@ -3999,30 +5063,29 @@ checkflex:
     */
     if ((call_mode == 0) && (nargs > 0))
     {
-        for (dptr = octx->desc_cache;
-             dptr != (descstruct *)0;
-             dptr = dptr->next)
+        desc_sync(octx);
+        dslot = desc_enter(octx);
+        dptr = desc_find(octx, spath);
+        if (dptr)
         {
-            if (str_compare(dptr->pname, spath, -1, 1) == 0)
+            sptr = dptr->pargs;
+            if (sptr)
             {
-                sptr = dptr->pargs;
-                if (sptr)
+                while (*sptr)
                 {
-                    while (*sptr)
+                    for (i = 0; i < nargs; ++i)
                     {
-                        for (i = 0; i < nargs; ++i)
+                        if (!str_compare(sptr, param_name[i], -1, 1))
                         {
-                            if (str_compare(sptr, param_name[i], -1, 1))
-                            {
-                                if (param_count[i] == 0) param_count[i] = 1;
-                                break;
-                            }
+                            if (param_count[i] == 0) param_count[i] = 1;
+                            break;
                         }
-                        sptr += (str_length(sptr) + 1);
                     }
+                    sptr += (str_length(sptr) + 1);
                 }
             }
         }
+        desc_leave(octx, dslot);
     }
 
     if (wpg_flag)
@@ -4457,9 +5520,15 @@ checkflex:
     ** Allocate array buffer space (max of input and output arrays):
     */
     if (++nwidth > HTBUF_ENV_MAX) nwidth = HTBUF_ENV_MAX;
-    if (++vwidth > HTBUF_ENV_MAX) vwidth = HTBUF_ENV_MAX;
     if (nwidth < HTBUF_ENV_NAM) nwidth = HTBUF_ENV_NAM;
 
+    /*
+    ** The environment is bound by pointer, so only the actual value
+    ** lengths are sent; keep the value bind width fixed at the maximum
+    ** so that it doesn't vary (and force new cursors) between requests.
+    */
+    vwidth = HTBUF_ENV_MAX;
+
     /*
     ** Dynamically computing HTBUF_LINE_LENGTH based on
     ** the character set could save memory; enough space
@@ -4472,12 +5541,7 @@ checkflex:
     ** ### CREATE A union/struct THAT CAN MORE CLEARLY SHOW
     ** ### THE VARIOUS USAGE SCENARIOS FOR IT.
     */
-    esize = (nwidth + vwidth) * nenv;
     osize = HTBUF_ARRAY_SIZE * HTBUF_LINE_LENGTH;
-    if (esize > osize)
-        osize = esize;
-    else if ((nenv * (nwidth + HTBUF_ENV_MAX)) < osize)
-        vwidth = HTBUF_ENV_MAX;
     outbuf = morq_get_buffer(r, osize); /* Use static buffer if possible */
     if (!outbuf)
     {
@@ -4549,8 +5613,25 @@ checkflex:
         return(rstatus);
     }
 
-    /* Transfer the environment variables to a buffer array */
-    transfer_env(r, &senv, remote_addr, nwidth, vwidth, nenv, outbuf);
+    /*
+    ** If fusing the CGI environment into the procedure call, build
+    ** the fused statement.
+    */
+    if ((octx->altflags & ALT_MODE_FUSED) && (!file_flag) && (!filelist))
+    {
+        fsize = str_length(octx->fuse_stmt) + str_length(stmt) + 8;
+        fstmt = (char *)morq_alloc(r, fsize, 0);
+        if (fstmt)
+          if (!owa_fuse_statement(octx, stmt, fstmt, fsize))
+            fstmt = (char *)0;
+    }
+
+    /* Point the environment record at the environment variables */
+    m = (nenv * 2 + 1) * sizeof(char *);
+    envptrs = (char **)morq_alloc(r, m, 0);
+    if (!envptrs) return(mem_error(r, m, diagflag));
+    m = transfer_env(r, &senv, remote_addr, nwidth, vwidth, nenv, envptrs);
+    if (m < 0) return(mem_error(r, m, diagflag));
     senv.authuser = authuser;
     senv.authpass = authpass;
 
@@ -4600,9 +5681,29 @@ checkflex:
     ** 5. Close OCI connection
     */
     owa_req->lock_time = get_elapsed_time(stime);
-    c = (nopool_flag) ? (connection *)0 : get_connection(octx, session);
+    shed = 0;
+    c = (nopool_flag) ? (connection *)0 : get_connection(octx, session, &shed);
     if (!c)
     {
+        /*
+        ** If the admission queue turned the request away, don't
+        ** make a throw-away connection; tell the client to come back.
+        */
+        if (shed)
+        {
+          if (diagflag & DIAG_ERROR)
+            debug_out(octx->diagfile,
+                      "Queue full or timed out for request [%s], PID: %s\n",
+                      spath, pidstr, 0, 0);
+          if (octx->q_retry > 0)
+          {
+            char numbuf[LONG_MAXSTRLEN];
+            str_itoa(octx->q_retry, numbuf);
+            morq_table_put(r, OWA_TABLE_HEADERR, 0, "Retry-After", numbuf);
+          }
+          return(HTTP_SERVICE_UNAVAILABLE);
+        }
+
         /*
         ** If we can't get a connection, see if the request should simply
         ** be aborted
@@ -4668,12 +5769,29 @@ retry:
           }
           else /* Otherwise be sure to set up the connection NLS */
             sql_set_nls(c, octx);
+
+          /* Now that NLS is set up, let the cleanup thread preload */
+          if ((vctx->desc_preload) && (!(vctx->desc_loaded)))
+            if ((octx->desc_schema) && (*(octx->desc_schema) == '*'))
+              if (!(octx->authrealm))
+                mowa_thread_wake(octx);
         }
 
         ++sphase;
         owa_req->wait_time = get_elapsed_time(stime);
-        status = owa_passenv(c, octx, &senv, owa_req);
-        debug_sql(octx, "passenv", pidstr, status, (char *)0);
+        if (fstmt)
+        {
+            /* Environment will be passed with the procedure call */
+#ifndef RESET_AFTER_EXEC
+            if (c->c_lock == C_LOCK_INUSE)
+                status = owa_reset(c, octx);
+#endif
+        }
+        else
+        {
+            status = owa_passenv(c, octx, &senv, owa_req);
+            debug_sql(octx, "passenv", pidstr, status, (char *)0);
+        }
         c->c_lock = C_LOCK_INUSE;
 
         if (status == OCI_SUCCESS)
@@ -4720,12 +5838,58 @@ retry:
                   /* Call single handling procedure */
                   c->ncflag |= (octx->ncflag & (UNI_MODE_USER | UNI_MODE_RAW));
                   if (raw_post) c->ncflag |= UNI_MODE_RAW;
-                  status = owa_runplsql(c, stmt, outbuf, xargs, nargs,
-                                        param_value, param_count, param_width,
+                  status = owa_runplsql(c, (fstmt) ? fstmt : stmt, outbuf,
+                                        xargs, nargs, param_value,
+                                        param_count, param_width,
                                         param_ptrs, param_lens, octx->arr_round,
-                                        cs_id, zero_args);
+                                        cs_id, zero_args, octx,
+                                        (fstmt) ? &senv : (env_record *)0,
+                                        owa_req);
                   c->ncflag &= ~(UNI_MODE_USER | UNI_MODE_RAW);
-                  debug_sql(octx, "runplsql", pidstr, status, (char *)0);
+                  debug_sql(octx, (fstmt) ? "fused" : "runplsql",
+                            pidstr, status, (char *)0);
+
+                  /*
+                  ** With a fused call, this is the first round-trip on a
+                  ** pooled connection; if the session turns out to be dead,
+                  ** allow the retry that a failed owa_passenv would get.
+                  ** Only errors raised before anything runs qualify (not
+                  ** logged on, not connected), since the block includes
+                  ** the user's procedure and it must not run twice.  A
+                  ** killed session or a link lost mid-call (ORA-28,
+                  ** ORA-3113, ORA-3135) may have run part of it.
+                  */
+                  if ((fstmt) && (retrycount == 1))
+                    if ((status == 1012) || (status == 3114))
+                      retrycount = 0;
+
+                  if ((fstmt) && (status == PLSQL_ERR) &&
+                      (str_substr(errbuf, PLSQL_ARGERR, 0)))
+                  {
+                      /*
+                      ** The fused block failed to compile, so nothing
+                      ** was run.  Fall back to passing the environment
+                      ** separately, and re-run the plain call so that
+                      ** the describe logic below can repair it.
+                      */
+                      fstmt = (char *)0;
+                      status = owa_passenv(c, octx, &senv, owa_req);
+                      debug_sql(octx, "passenv", pidstr, status, (char *)0);
+                      if (status == OCI_SUCCESS)
+                      {
+                        c->ncflag |= (octx->ncflag &
+                                      (UNI_MODE_USER | UNI_MODE_RAW));
+                        if (raw_post) c->ncflag |= UNI_MODE_RAW;
+                        status = owa_runplsql(c, stmt, outbuf, xargs, nargs,
+                                              param_value, param_count,
+                                              param_width, param_ptrs,
+                                              param_lens, octx->arr_round,
+                                              cs_id, zero_args, octx,
+                                              (env_record *)0, owa_req);
+                        c->ncflag &= ~(UNI_MODE_USER | UNI_MODE_RAW);
+                        debug_sql(octx, "runplsql", pidstr, status, (char *)0);
+                      }
+                  }
                 }
 
                 if ((call_mode != 3) && (status == PLSQL_ERR) &&
@@ -4771,7 +5935,8 @@ rerun_statement:
                                               nargs, param_value, param_count,
                                               param_width, param_ptrs,
                                               param_lens, octx->arr_round,
-                                              cs_id, zero_args);
+                                              cs_id, zero_args, octx,
+                                              (env_record *)0, owa_req);
                         c->ncflag &= ~(UNI_MODE_USER | UNI_MODE_RAW);
                         debug_sql(octx, "redescribe",
                                   pidstr, status, (char *)0);
@@ -4844,7 +6009,8 @@ rerun_statement:
                                           param_value, param_count,
                                           param_width, param_ptrs,
                                           param_lens, octx->arr_round,
-                                          cs_id, zero_args);
+                                          cs_id, zero_args, octx,
+                                          (env_record *)0, owa_req);
                     c->ncflag &= ~(UNI_MODE_USER | UNI_MODE_RAW);
                     debug_sql(octx, "rerun", pidstr, status, (char *)0);
                 }
@@ -4881,6 +6047,8 @@ rerun_statement:
                 }
                 else if ((wpg_flag) && (*pdocload))
                 {
+                  int doc_cached = 0;
+
                   *pcdisp = '\0';
                   status = owa_getheader(c, octx, r, pmimetype, pcdisp,
                                          outbuf, &rstatus);
@@ -4923,12 +6091,24 @@ rerun_statement:
                       ** ### For now this is not supported because I don't
                       ** ### know if Apex actually uses that mode or not.
                       */
-                      status = owa_rlobtable(c, octx, r, fname,
-                                             pmimetype, pcdisp, outbuf);
-                      debug_sql(octx, "rlobtable", pidstr, status, (char *)0);
+                      doc_cached = owa_rlobcache(octx, r,
+                                                 (octx->authrealm) ?
+                                                 authuser : (char *)0,
+                                                 fname, pmimetype, pcdisp);
+                      if (!doc_cached)
+                      {
+                        status = owa_rlobtable(c, octx, r, fname,
+                                               pmimetype, pcdisp, outbuf);
+                        debug_sql(octx, "rlobtable", pidstr, status, (char *)0);
+                      }
                   }
 
-                  if (c->blob_ind != (ub2)-1)
+                  if (doc_cached)
+                  {
+                      /* Sent from documents prefetched by an earlier page */
+                      debug_sql(octx, "rlobcache", pidstr, status, (char *)0);
+                  }
+                  else if (c->blob_ind != (ub2)-1)
                   {
                       /* Use the returned mime type and BLOB */
                       status = owa_readlob(c, octx, r, pmimetype, pmimetype,
@@ -4949,6 +6129,29 @@ rerun_statement:
                     status = owa_getpage(c, octx, r, physical, outbuf,
                                          &rstatus, owa_req, rset_flag);
                     debug_sql(octx, "getpage", pidstr, status, (char *)0);
+
+                    /*
+                    ** If the page announced documents it refers to,
+                    ** finish sending it, then fetch them into the cache
+                    ** while the connection is still held.  The fetch is
+                    ** bounded, and skipped if other requests are queued.
+                    */
+                    if (c->docnames)
+                    {
+                        if ((status == OCI_SUCCESS) && (c->mem_err == 0))
+                        {
+                            sword bstatus;
+
+                            morq_write(r, (char *)0, 0);
+                            bstatus = owa_rlobbatch(c, octx, r,
+                                                    (octx->authrealm) ?
+                                                    authuser : (char *)0,
+                                                    c->docnames, outbuf);
+                            debug_sql(octx, "rlobbatch", pidstr, bstatus,
+                                      (char *)0);
+                        }
+                        c->docnames = (char *)0;
+                    }
                 }
                 else /* File download, return mime-typed content */
                 {
@@ -5074,7 +6277,7 @@ void owa_cleanup(owa_context *octx)
     /* Clean up connection pool, close OCI connections */
     do
     {
-        c = lock_connection(octx, (char *)0);
+        c = lock_connection(octx, (char *)0, octx->pool_wait_ms);
         if (c)
         {
             if (c->c_lock == C_LOCK_INUSE)
@@ -5093,4 +6296,7 @@ void owa_cleanup(owa_context *octx)
             unlock_connection(octx, c);
         }
     } while (c);
+
+    /* Close the shared session pool, if any */
+    sql_spool_close(octx);
 }
@@ -82,6 +82,15 @@
 ** 10/13/2015   D. McMahon      Limit CGIPOST buffer to 32k (per Fulvio Bille)
 ** 11/29/2021   D. McMahon      Return OK for blank pages if dav_mode set
 ** 03/30/2022   D. McMahon      Use HTBUF_ENV_MAX for session cookie size
+** 10/17/2026   D. McMahon      Add fused CGI environment/procedure call
+** 10/17/2026   D. McMahon      Use OCI statement cache for procedure calls
+** 10/17/2026   D. McMahon      Write GET_PAGE batches from array slices
+** 10/17/2026   D. McMahon      Bind CGI environment by pointer
+** 10/17/2026   D. McMahon      Add DELTA mode for the CGI environment
+** 10/17/2026   D. McMahon      Capture X-Owa-Prefetch document lists
+** 10/17/2026   D. McMahon      Compare DELTA environment values in full
+** 10/17/2026   D. McMahon      Ignore X-Owa-Prefetch without OwaDocLobs CACHE
+** 10/17/2026   D. McMahon      Stop GET_PAGE output when morq_writev fails
 */
 
 #define WITH_OCI
@@ -123,6 +132,16 @@ static char sql_stmt1c[] = "begin\n"
                            "    OWA.IP_ADDRESS := :ipaddr;\n"
                            "  end if;\n"
                            "end;";
+static char sql_stmt1d[] = "declare\n"
+                           "  pos DBMS_SQL.NUMBER_TABLE;\n"
+                           "  val OWA.VC_ARR;\n"
+                           "begin\n"
+                           "  pos := :posarr;\n"
+                           "  val := :valarr;\n"
+                           "  for i in 1..:ecount loop\n"
+                           "    OWA.CGI_VAR_VAL(pos(i)) := val(i);\n"
+                           "  end loop;\n"
+                           "end;";
 static char sql_stmt2a[] = "begin\n"
                            "  OWA.USER_ID := :usr;\n"
                            "  OWA.PASSWORD := :pwd;\n"
@@ -171,6 +190,10 @@ int owa_reset(connection *c, owa_context *octx)
 
     status = sql_exec(c, c->stmhp5, (ub4)1, 0);
 
+    /* HTP.INIT leaves the OWA package state alone; the others don't */
+    if ((status != OCI_SUCCESS) || (octx->rsetflag != RSET_MODE_INIT))
+        c->env_count = 0;
+
     if (status != OCI_SUCCESS)
     {
         if (c->errbuf) c->lastsql = octx->reset_stmt;
@@ -187,24 +210,239 @@ int owa_reset(connection *c, owa_context *octx)
 }
 
 /*
-** Pass environment information to OWA
+** Bind variables for the CGI environment statement; these must
+** stay in scope until the statement has been executed.
 */
-int owa_passenv(connection *c, owa_context *octx,
-                env_record *penv, owa_request *owa_req)
+typedef struct env_binds
 {
-    sword    status;
-    sb4      oerrno;
     sb4      ecount;
     ub4      asize;
-    ub4      amax;
     sb4      wait_time;
     sb4      pieces[4]; /* ### Can't handle IPV6 ### */
     ub4      npieces;
     sb4      ipflag;
+    sb4      secflag;
+    int      npos;      /* Number of bind positions consumed */
+} env_binds;
+
+/*
+** Keep a copy of the CGI environment just sent on this connection, as
+** null-terminated name/value pairs, so that the next request can send
+** only the values that changed.  The values have to be compared in
+** full: a stale value left behind could be another user's cookie.
+*/
+static void env_remember(connection *c, env_record *penv)
+{
+    int      i;
+    int      n;
+    char    *sptr;
+
+    c->env_count = 0;
+
+    for (n = 0, i = 0; i < penv->count; ++i)
+        n += str_length(penv->names[i]) + str_length(penv->values[i]) + 2;
+    if (n > c->env_size)
+    {
+        if (c->env_copy) mem_free((void *)(c->env_copy));
+        c->env_copy = (char *)mem_alloc(n);
+        c->env_size = (c->env_copy) ? n : 0;
+        if (!(c->env_copy)) return;
+    }
+
+    sptr = c->env_copy;
+    for (i = 0; i < penv->count; ++i)
+    {
+        n = str_length(penv->names[i]) + 1;
+        mem_copy(sptr, penv->names[i], n);
+        sptr += n;
+        n = str_length(penv->values[i]) + 1;
+        mem_copy(sptr, penv->values[i], n);
+        sptr += n;
+    }
+
+    c->env_ip = penv->ipaddr;
+    c->env_count = penv->count;
+}
+
+/*
+** Send only the CGI values that changed since the last request on this
+** connection, by position within the OWA.CGI_VAR_VAL array.  Returns
+** OCI_CONTINUE if the names differ and a full send is needed.
+*/
+static sword env_delta(connection *c, owa_context *octx, env_record *penv)
+{
+    sword    status;
+    int      i;
+    char    *sptr;
+    sb4      ecount;
+    ub4      asize;
+    sb4      pos[HTBUF_ENV_ARR];
+    char    *vals[HTBUF_ENV_ARR];
+
+    if (c->env_count != penv->count) return(OCI_CONTINUE);
+    if (c->env_ip != penv->ipaddr) return(OCI_CONTINUE);
+
+    ecount = 0;
+    sptr = c->env_copy;
+    for (i = 0; i < penv->count; ++i)
+    {
+        if (str_compare(sptr, penv->names[i], -1, 0))
+            return(OCI_CONTINUE);
+        sptr += str_length(sptr) + 1;
+        if (str_compare(sptr, penv->values[i], -1, 0))
+        {
+            if (ecount == HTBUF_ENV_ARR) return(OCI_CONTINUE);
+            pos[ecount] = (sb4)(i + 1);
+            vals[ecount] = penv->values[i];
+            ++ecount;
+        }
+        sptr += str_length(sptr) + 1;
+    }
+
+    /* Nothing changed, so there's nothing to send */
+    if (ecount == 0) return(OCI_SUCCESS);
+
+    /* Forget the old values unless the update goes through */
+    c->env_count = 0;
+    c->lastsql = octx->delta_stmt;
+
+    status = sql_parse(c, c->stmhp3, octx->delta_stmt, -1);
+    if (status != OCI_SUCCESS) return(status);
+
+    asize = (ub4)ecount;
+    status = sql_bind_iarr(c, c->stmhp3, (ub4)1, pos,
+                           &asize, (ub4)HTBUF_ENV_ARR);
+    if (status != OCI_SUCCESS) return(status);
+    status = sql_bind_strs(c, c->stmhp3, (ub4)2, vals,
+                           (sb4)(penv->vwidth), &asize, (ub4)HTBUF_ENV_ARR);
+    if (status != OCI_SUCCESS) return(status);
+    status = sql_bind_int(c, c->stmhp3, (ub4)3, &ecount);
+    if (status != OCI_SUCCESS) return(status);
+
+    status = sql_exec(c, c->stmhp3, (ub4)1, 0);
+    if (status == OCI_SUCCESS) env_remember(c, penv);
+
+    return(status);
+}
+
+/*
+** Bind the CGI environment (and optionally the security variables)
+** to a statement, starting at bind position 1.
+*/
+static sword bind_cgienv(connection *c, owa_context *octx, OraCursor stmhp,
+                         env_record *penv, owa_request *owa_req,
+                         env_binds *eb, int sec_flag)
+{
+    sword    status;
+    ub4      amax;
+    ub4      pos;
     char    *post_args;
     char    *usr;
     char    *pwd;
 
+    eb->ecount = (sb4)penv->count;
+    eb->asize = (ub4)penv->count;
+    amax = eb->asize;
+    if (amax < (ub4)HTBUF_ENV_ARR) amax = (ub4)HTBUF_ENV_ARR;
+
+    status = sql_bind_int(c, stmhp, (ub4)1, &(eb->ecount));
+    if (status != OCI_SUCCESS) return(status);
+    status = sql_bind_strs(c, stmhp, (ub4)2, penv->names,
+                           (sb4)(penv->nwidth), &(eb->asize), amax);
+    if (status != OCI_SUCCESS) return(status);
+    status = sql_bind_strs(c, stmhp, (ub4)3, penv->values,
+                           (sb4)(penv->vwidth), &(eb->asize), amax);
+    if (status != OCI_SUCCESS) return(status);
+    pos = 3;
+
+    if (octx->altflags & (ALT_MODE_CGITIME | ALT_MODE_CGIPOST))
+    {
+        sb4 slen;
+
+        eb->wait_time = (sb4)(owa_req->connect_time - owa_req->lock_time);
+        post_args = (char *)0;
+        if (octx->altflags & ALT_MODE_CGIPOST) post_args = owa_req->post_args;
+        if (!post_args) post_args = (char *)"";
+
+        status = sql_bind_int(c, stmhp, (ub4)4, &(eb->wait_time));
+        if (status != OCI_SUCCESS) return(status);
+        slen = str_length(post_args);
+        if (slen > HTBUF_PLSQL_MAX) slen = HTBUF_PLSQL_MAX;
+        status = sql_bind_chr(c, stmhp, (ub4)5, post_args, slen);
+        if (status != OCI_SUCCESS) return(status);
+        pos = 5;
+    }
+    else if (octx->altflags & ALT_MODE_IPADDR)
+    {
+        eb->pieces[0] = (sb4)((penv->ipaddr >> 24) & 0xFF);
+        eb->pieces[1] = (sb4)((penv->ipaddr >> 16) & 0xFF);
+        eb->pieces[2] = (sb4)((penv->ipaddr >>  8) & 0xFF);
+        eb->pieces[3] = (sb4)((penv->ipaddr      ) & 0xFF);
+
+        eb->npieces = (ub4)4;
+        eb->ipflag = (penv->ipaddr) ? 4 : 0;
+
+        status = sql_bind_int(c, stmhp, (ub4)4, &(eb->ipflag));
+        status = sql_bind_iarr(c, stmhp, (ub4)5, eb->pieces,
+                               &(eb->npieces), eb->npieces);
+        pos = 5;
+    }
+
+    if (sec_flag)
+    {
+        /*
+        ** The fused statement guards the security assignments
+        ** with a flag, so that they run only when the separate
+        ** statement would have been run.
+        */
+        usr = penv->authuser;
+        pwd = penv->authpass;
+        if (!usr) usr = (char *)"";
+        if (!pwd) pwd = (char *)"";
+
+        eb->secflag = ((*usr) || (*pwd) ||
+                       (octx->altflags & (ALT_MODE_GETRAW | ALT_MODE_KEEP)));
+
+        status = sql_bind_int(c, stmhp, pos + 1, &(eb->secflag));
+        if (status != OCI_SUCCESS) return(status);
+        if (!(*usr) && !(*pwd))
+        {
+            /*
+            ** Null bindings.  owa_passenv does this by setting out_ind,
+            ** but here the indicator is shared with the procedure's own
+            ** string arguments, which are bound later; a zero-length
+            ** bind is null without touching it.
+            */
+            status = sql_bind_chr(c, stmhp, pos + 2, usr, (sb4)0);
+            if (status != OCI_SUCCESS) return(status);
+            status = sql_bind_chr(c, stmhp, pos + 3, pwd, (sb4)0);
+        }
+        else
+        {
+            status = sql_bind_str(c, stmhp, pos + 2, usr, (sb4)-1);
+            if (status != OCI_SUCCESS) return(status);
+            status = sql_bind_str(c, stmhp, pos + 3, pwd, (sb4)-1);
+        }
+        if (status != OCI_SUCCESS) return(status);
+        pos += 3;
+    }
+
+    eb->npos = (int)pos;
+    return(status);
+}
+
+/*
+** Pass environment information to OWA
+*/
+int owa_passenv(connection *c, owa_context *octx,
+                env_record *penv, owa_request *owa_req)
+{
+    sword     status;
+    sb4       oerrno;
+    env_binds eb;
+    char     *usr;
+    char     *pwd;
+
     status = OCI_SUCCESS;
     c->errbuf[0] = '\0';
 
@@ -224,56 +462,30 @@ int owa_passenv(connection *c, owa_context *octx,
     }
 #endif
 
-    ecount = (sb4)penv->count;
-    asize = (ub4)penv->count;
-    amax = (ub4)asize;
-    if (amax < (ub4)HTBUF_ENV_ARR) amax = (ub4)HTBUF_ENV_ARR;
-
-    c->lastsql = octx->cgi_stmt;
-
-    status = sql_bind_int(c, c->stmhp1, (ub4)1, &ecount);
-    if (status != OCI_SUCCESS) goto passerr;
-    status = sql_bind_arr(c, c->stmhp1, (ub4)2, penv->names,
-                          (ub2 *)0, (sb4)(penv->nwidth), (sb2 *)0,
-                          &asize, amax);
-    if (status != OCI_SUCCESS) goto passerr;
-    status = sql_bind_arr(c, c->stmhp1, (ub4)3, penv->values,
-                          (ub2 *)0, (sb4)(penv->vwidth), (sb2 *)0,
-                          &asize, amax);
-    if (status != OCI_SUCCESS) goto passerr;
+    /*
+    ** If the session already holds an environment from the previous
+    ** request, try to send just the values that changed.
+    */
+    status = OCI_CONTINUE;
+    if (c->c_lock != C_LOCK_INUSE)
+        c->env_count = 0;
+    else if ((octx->delta_stmt[0]) && (c->env_count > 0) && (!c->spooled))
+        status = env_delta(c, octx, penv);
 
-    if (octx->altflags & (ALT_MODE_CGITIME | ALT_MODE_CGIPOST))
+    if (status == OCI_CONTINUE)
     {
-        sb4 slen;
+        c->lastsql = octx->cgi_stmt;
+        c->env_count = 0;
 
-        wait_time = (sb4)(owa_req->connect_time - owa_req->lock_time);
-        post_args = (char *)0;
-        if (octx->altflags & ALT_MODE_CGIPOST) post_args = owa_req->post_args;
-        if (!post_args) post_args = (char *)"";
-
-        status = sql_bind_int(c, c->stmhp1, (ub4)4, &wait_time);
-        if (status != OCI_SUCCESS) goto passerr;
-        slen = str_length(post_args);
-        if (slen > HTBUF_PLSQL_MAX) slen = HTBUF_PLSQL_MAX;
-        status = sql_bind_chr(c, c->stmhp1, (ub4)5, post_args, slen);
+        status = bind_cgienv(c, octx, c->stmhp1, penv, owa_req, &eb, 0);
         if (status != OCI_SUCCESS) goto passerr;
-    }
-    else if (octx->altflags & ALT_MODE_IPADDR)
-    {
-        pieces[0] = (sb4)((penv->ipaddr >> 24) & 0xFF);
-        pieces[1] = (sb4)((penv->ipaddr >> 16) & 0xFF);
-        pieces[2] = (sb4)((penv->ipaddr >>  8) & 0xFF);
-        pieces[3] = (sb4)((penv->ipaddr      ) & 0xFF);
 
-        npieces = (ub4)4;
-        ipflag = (penv->ipaddr) ? 4 : 0;
+        status = sql_exec(c, c->stmhp1, (ub4)1, 0);
+        if (status != OCI_SUCCESS) goto passerr;
 
-        status = sql_bind_int(c, c->stmhp1, (ub4)4, &ipflag);
-        status = sql_bind_iarr(c, c->stmhp1, (ub4)5, pieces, &npieces, npieces);
+        if (octx->delta_stmt[0]) env_remember(c, penv);
     }
-
-    status = sql_exec(c, c->stmhp1, (ub4)1, 0);
-    if (status != OCI_SUCCESS) goto passerr;
+    else if (status != OCI_SUCCESS) goto passerr;
 
     /*
     ** If Basic authentication information is present,
@@ -315,28 +527,55 @@ passerr:
     return(status);
 }
 
+/*
+** Build a fused statement that passes the CGI environment, sets the
+** security variables, and runs the user's procedure block in a single
+** round-trip.  Returns the length of the statement, or 0 if the
+** statement can't be fused.
+*/
+int owa_fuse_statement(owa_context *octx, char *stmt, char *outstmt, int olen)
+{
+    int flen;
+    int slen;
+
+    flen = str_length(octx->fuse_stmt);
+    if (flen == 0) return(0);
+    slen = str_length(stmt);
+    if ((flen + slen + 8) > olen) return(0);
+
+    mem_copy(outstmt, octx->fuse_stmt, flen);
+    mem_copy(outstmt + flen, stmt, slen);
+    flen += slen;
+    flen += str_concat(outstmt + flen, 0, "\nend;", -1);
+
+    return(flen);
+}
+
 /*
 ** Run PL/SQL procedure with arguments
 */
 int owa_runplsql(connection *c, char *stmt, char *outbuf, int xargs,
                  int nargs, char *values[], ub4 counts[], sb4 widths[],
                  char **pointers, ub2 *plens, un_long arr_round, int csid,
-                 int zero_flag)
+                 int zero_flag, owa_context *octx, env_record *penv,
+                 owa_request *owa_req)
 {
-    sword  status;
-    sb4    oerrno;
-    int    i, j;
-    char  *optr;
-    ub4    amax;
-    int    ocsid = c->csid;
-    int    hacked_flag = 0;
+    sword     status;
+    sb4       oerrno;
+    int       i, j;
+    char     *optr;
+    ub4       amax;
+    int       ocsid = c->csid;
+    int       hacked_flag = 0;
+    env_binds eb;
+    OraCursor stmhp;
 
     status = OCI_SUCCESS;
 
     c->lastsql = stmt;
     c->errbuf[0] = '\0';
 
-    status = sql_parse(c, c->stmhp3, stmt, -1);
+    status = sql_prepare(c, &stmhp, stmt, -1);
     if (status != OCI_SUCCESS) goto runerr;
 
     /* Set indicators for unbound arguments to null */
@@ -347,9 +586,25 @@ int owa_runplsql(connection *c, char *stmt, char *outbuf, int xargs,
 
     optr = outbuf;
 
+    j = 0;
+
+    /*
+    ** For a fused statement, the CGI environment and security
+    ** variables occupy the leading bind positions.
+    */
+    if (penv)
+    {
+        i = c->ncflag;
+        c->ncflag &= ~(UNI_MODE_USER | UNI_MODE_RAW);
+        status = bind_cgienv(c, octx, stmhp, penv, owa_req, &eb, 1);
+        c->ncflag = i;
+        c->env_count = 0;
+        if (status != OCI_SUCCESS) goto runerr;
+        j = eb.npos;
+    }
+
     if (csid) c->csid = csid;
 
-    j = 0;
     for (i = 0; i < nargs; ++i)
     {
         ub4 old_count = counts[i];
@@ -377,7 +632,7 @@ int owa_runplsql(connection *c, char *stmt, char *outbuf, int xargs,
         if (values[i] == (char *)0)
         {
             amax = (ub4)util_round((un_long)old_count, arr_round);
-            status = sql_bind_ptrs(c, c->stmhp3, (ub4)(j + 1), pointers,
+            status = sql_bind_ptrs(c, stmhp, (ub4)(j + 1), pointers,
                                    widths[i], counts + i, amax);
             if (c->ncflag & UNI_MODE_RAW) plens += old_count;
         }
@@ -387,40 +642,40 @@ int owa_runplsql(connection *c, char *stmt, char *outbuf, int xargs,
 
           if (c->ncflag & UNI_MODE_RAW)
           {
-            status = sql_bind_rarr(c, c->stmhp3, (ub4)(j + 1), values[i],
+            status = sql_bind_rarr(c, stmhp, (ub4)(j + 1), values[i],
                                    plens, widths[i], (sb2 *)0, counts + i,
                                    amax);
             plens += old_count;
           }
           else
-            status = sql_bind_arr(c, c->stmhp3, (ub4)(j + 1), values[i],
+            status = sql_bind_arr(c, stmhp, (ub4)(j + 1), values[i],
                                   (ub2 *)0, widths[i], (sb2 *)0, counts + i,
                                   amax);
         }
         else if (values[i] == var_blob)
         {
-            status = sql_bind_lob(c, c->stmhp3, (ub4)(j + 1), SQLT_BLOB);
+            status = sql_bind_lob(c, stmhp, (ub4)(j + 1), SQLT_BLOB);
             if (c->ncflag & UNI_MODE_RAW) ++plens;
         }
         else if (values[i] == var_clob)
         {
             c->csid = ocsid;
-            status = sql_bind_lob(c, c->stmhp3, (ub4)(j + 1), SQLT_CLOB);
+            status = sql_bind_lob(c, stmhp, (ub4)(j + 1), SQLT_CLOB);
             if (c->ncflag & UNI_MODE_RAW) ++plens;
         }
         else if (values[i] == var_bfile)
         {
-            status = sql_bind_lob(c, c->stmhp3, (ub4)(j + 1), SQLT_BFILE);
+            status = sql_bind_lob(c, stmhp, (ub4)(j + 1), SQLT_BFILE);
             if (c->ncflag & UNI_MODE_RAW) ++plens;
         } 
         else if (values[i] == var_nlob)
         {
-            status = sql_bind_lob(c, c->stmhp3, (ub4)(j + 1), 0);
+            status = sql_bind_lob(c, stmhp, (ub4)(j + 1), 0);
             if (c->ncflag & UNI_MODE_RAW) ++plens;
         }
         else if (values[i] == var_rset)
         {
-            status = sql_bind_cursor(c, c->stmhp3, (ub4)(j + 1));
+            status = sql_bind_cursor(c, stmhp, (ub4)(j + 1));
         }
         else if ((values[i] == var_stmt) || (values[i] == var_bind) ||
                  (values[i] == var_clen) || (values[i] == var_fname) ||
@@ -429,7 +684,7 @@ int owa_runplsql(connection *c, char *stmt, char *outbuf, int xargs,
         {
             c->csid = ocsid;
             *optr = '\0';
-            status = sql_bind_str(c, c->stmhp3, (ub4)(j + 1), optr, widths[i]);
+            status = sql_bind_str(c, stmhp, (ub4)(j + 1), optr, widths[i]);
             optr += widths[i];
             if (c->ncflag & UNI_MODE_RAW) ++plens;
         }
@@ -437,13 +692,13 @@ int owa_runplsql(connection *c, char *stmt, char *outbuf, int xargs,
         {
           if (c->ncflag & UNI_MODE_RAW)
           {
-            status = sql_bind_raw(c, c->stmhp3, (ub4)(j + 1),
+            status = sql_bind_raw(c, stmhp, (ub4)(j + 1),
                                   values[i], plens, widths[i]);
             ++plens;
           }
           else
           {
-            status = sql_bind_str(c, c->stmhp3, (ub4)(j + 1),
+            status = sql_bind_str(c, stmhp, (ub4)(j + 1),
                                   values[i], widths[i]);
           }
         }
@@ -451,7 +706,7 @@ int owa_runplsql(connection *c, char *stmt, char *outbuf, int xargs,
         ++j;
     }
 
-    status = sql_exec(c, c->stmhp3, (ub4)1, 0);
+    status = sql_exec(c, stmhp, (ub4)1, 0);
 
     /* If counts were altered due to the zero_flag, restore them */
     if (hacked_flag)
@@ -464,6 +719,8 @@ runerr:
     {
         oerrno = sql_get_error(c); 
         if (oerrno) status = oerrno;
+        /* Don't keep a failed statement in the cache */
+        sql_release(c, 1);
     }
     else
         c->lastsql = (char *)0;
@@ -1029,7 +1286,8 @@ static int owa_getrows(connection *c, owa_context *octx, request_rec *r,
     if (lob_column > 0)
     {
         /* ### For now, only CLOB is supported, on a single column ### */
-        status = sql_define_lob(c, c->rset, lob_column, (ub2)SQLT_CLOB);
+        status = sql_define_lob(c, c->rset, lob_column, (ub2)SQLT_CLOB,
+                                (ub4)0);
     }
     /* No LOB columns so define all selected columns as strings */
     else
@@ -1343,7 +1601,7 @@ int owa_getpage(connection *c, owa_context *octx, request_rec *r,
     sword    status;
     sb4      oerrno;
     int      diagflag;
-    char    *optr;
+    char    *optr = outbuf;
     char    *sptr;
     char    *eptr;
     char    *rawbuf;
@@ -1581,6 +1839,34 @@ int owa_getpage(connection *c, owa_context *octx, request_rec *r,
                 olen = str_length(outbuf);
             }
         }
+        else if ((content_flag) && !(diagflag & DIAG_CONTENT))
+        {
+            /*
+            ** The header has already been sent, so there's no need
+            ** to keep the lines together.  Write them straight from
+            ** the array slices instead of re-packing them first.
+            */
+            olen = (int)morq_writev(r, outbuf, bufwidth, lens, (int)ecount);
+            if (olen < 0)
+            {
+                /* The client is gone; don't cache a partial page */
+                physical = (char *)0;
+                olen = 0;
+                break;
+            }
+#ifndef NO_FILE_CACHE
+            if (!InvalidFile(fp))
+                for (i = 0; i < (int)ecount; ++i)
+                    if (lens[i] > 0)
+                        file_write_data(fp, outbuf + (i * bufwidth),
+                                        (int)lens[i]);
+#endif
+            total += (ub4)olen;
+            if (diagflag & DIAG_RESPONSE)
+                debug_out(octx->diagfile, "  Wrote block of %d bytes\n",
+                          (char *)0, (char *)0, olen, 0);
+            olen = 0;
+        }
         else
         {
             sptr = outbuf;
@@ -1853,7 +2139,18 @@ int owa_getpage(connection *c, owa_context *octx, request_rec *r,
                                 break;
                             }
                         nls_sanitize_header(sptr);
-                        if (errhdr_code != 0)
+                        if ((octx->doc_table) &&
+                            (!str_compare(headval, "X-Owa-Prefetch", -1, 1)))
+                        {
+                            /* Documents to fetch after the page is sent */
+                            i = str_length(sptr);
+                            if (octx->doclife > 0)
+                                c->docnames = (char *)morq_alloc(r,
+                                                      (size_t)(i + 1), 0);
+                            if (c->docnames)
+                                mem_copy(c->docnames, sptr, i + 1);
+                        }
+                        else if (errhdr_code != 0)
                             morq_table_put(r,OWA_TABLE_HEADERR,0,headval,sptr);
                         else
                             morq_table_put(r,OWA_TABLE_HEADOUT,0,headval,sptr);
@@ -2042,6 +2339,15 @@ int owa_getpage(connection *c, owa_context *octx, request_rec *r,
                 debug_out(octx->diagfile, "  Wrote block of %d bytes\n",
                           (char *)0, (char *)0, olen, 0);
         }
+
+        /*
+        ** In streaming mode, push each batch out to the client as
+        ** soon as it's fetched rather than letting the server hold
+        ** it.  Without a Content-Length the server will switch to
+        ** chunked transfer encoding.
+        */
+        if ((octx->altflags & ALT_MODE_STREAM) && (ecount == (sb4)arrlength))
+            morq_write(r, (char *)0, 0L);
     }
 
 geterr:
@@ -2358,12 +2664,47 @@ headerr:
     return(status);
 }
 
+/*
+** Copy the body of a "begin ... end;" block, dropping the outer
+** begin and end keywords; returns the number of bytes copied.
+*/
+static int copy_block_body(char *outbuf, char *stmt)
+{
+    char *eptr;
+
+    stmt += 5; /* Skip "begin" */
+    while ((*stmt == ' ') || (*stmt == '\n')) ++stmt;
+    eptr = stmt + str_length(stmt) - 4; /* Drop "end;" */
+    while ((eptr > stmt) && ((eptr[-1] == ' ') || (eptr[-1] == '\n')))
+        --eptr;
+
+    return(str_concat(outbuf, 0, stmt, (int)(eptr - stmt)));
+}
+
+/*
+** Copy a statement, substituting the alternate package name for "OWA."
+*/
+static void copy_alternate(char *outbuf, char *stmt, char *alternate)
+{
+    char *nptr;
+
+    if (alternate)
+    {
+        while ((nptr = str_substr(stmt, "OWA.", 0)))
+        {
+            outbuf += str_concat(outbuf, 0, stmt, (int)(nptr - stmt));
+            outbuf += str_concat(outbuf, 0, alternate, 32);
+            stmt = nptr + 3;
+        }
+    }
+    str_copy(outbuf, stmt);
+}
+
 void owa_set_statements(owa_context *octx)
 {
     char *alternate;
     char *sptr;
     char *aptr;
-    char *nptr;
 
     switch (octx->rsetflag)
     {
@@ -2381,47 +2722,18 @@ void owa_set_statements(owa_context *octx)
 
     if (alternate)
     {
-        sptr = octx->cgi_stmt;
-
         if (octx->altflags & (ALT_MODE_CGITIME | ALT_MODE_CGIPOST))
             aptr = sql_stmt1b;
         else if (octx->altflags & ALT_MODE_IPADDR)
             aptr = sql_stmt1c;
         else
             aptr = sql_stmt1a;
+        copy_alternate(octx->cgi_stmt, aptr, alternate);
 
-        do
-        {
-            nptr = str_substr(aptr, "OWA.", 0);
-            if (nptr)
-            {
-                sptr += str_concat(sptr, 0, aptr, (int)(nptr - aptr));
-                sptr += str_concat(sptr, 0, alternate, 32);
-                aptr = nptr + 3;
-            }
-            else
-                str_copy(sptr, aptr);
-        }
-        while (nptr);
-
-        sptr = octx->sec_stmt;
         if (octx->altflags & ALT_MODE_GETRAW)       aptr = sql_stmt2c;
         else if (octx->altflags & ALT_MODE_SETSEC)  aptr = sql_stmt2b;
         else                                        aptr = sql_stmt2a;
-
-        do
-        {
-            nptr = str_substr(aptr, "OWA.", 0);
-            if (nptr)
-            {
-                sptr += str_concat(sptr, 0, aptr, (int)(nptr - aptr));
-                sptr += str_concat(sptr, 0, alternate, 32);
-                aptr = nptr + 3;
-            }
-            else
-                str_copy(sptr, aptr);
-        }
-        while (nptr);
+        copy_alternate(octx->sec_stmt, aptr, alternate);
 
         sptr = octx->get_stmt;
         if (octx->altflags & ALT_MODE_GETRAW)
@@ -2475,6 +2787,41 @@ void owa_set_statements(owa_context *octx)
                                                           sql_stmt2a);
         }
     }
+
+    /*
+    ** Build the preamble for the fused statement:
+    **
+    **   begin
+    **     <cgi_stmt body>
+    **     if (:secflag > 0) then
+    **       <sec_stmt body>
+    **     end if;
+    **     <user procedure block>
+    **   end;
+    */
+    sptr = octx->fuse_stmt;
+    *sptr = '\0';
+    if ((octx->altflags & ALT_MODE_FUSED) &&
+        (!(octx->dav_handler) || (octx->dav_mode <= 1)))
+    {
+        sptr += str_concat(sptr, 0, "begin\n  ", -1);
+        sptr += copy_block_body(sptr, octx->cgi_stmt);
+        sptr += str_concat(sptr, 0, "\n  if (:secflag > 0) then\n    ", -1);
+        sptr += copy_block_body(sptr, octx->sec_stmt);
+        sptr += str_concat(sptr, 0, "\n  end if;\n", -1);
+    }
+
+    /*
+    ** Build the CGI delta statement only if the OWA package state
+    ** survives from one request to the next, and only if the CGI
+    ** statement carries nothing that changes on every request.
+    */
+    octx->delta_stmt[0] = '\0';
+    if ((octx->altflags & ALT_MODE_DELTA) &&
+        !(octx->altflags & (ALT_MODE_CGITIME | ALT_MODE_CGIPOST)) &&
+        ((octx->altflags & ALT_MODE_KEEP) || (octx->authrealm) ||
+         (octx->rsetflag == RSET_MODE_INIT)))
+        copy_alternate(octx->delta_stmt, sql_stmt1d, alternate);
 }
 
 /*
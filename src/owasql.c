@@ -83,6 +83,15 @@
 ** 03/22/2021   D. McMahon      Ensure handle free on sql_disconnect
 ** 06/29/2021   D. McMahon      Add sql_get_version
 ** 05/08/2023   D. McMahon      Add sql_set_nls(), prioritize user NLS setting
+** 10/17/2026   D. McMahon      Add OCI statement cache (sql_prepare/sql_release)
+** 10/17/2026   D. McMahon      Add shared OCI environment and session pool
+** 10/17/2026   D. McMahon      Add sql_describe_tables for describe preloading
+** 10/17/2026   D. McMahon      Add sql_bind_strs
+** 10/17/2026   D. McMahon      Free connection env hashes on disconnect
+** 10/17/2026   D. McMahon      Clear pending reset on disconnect
+** 10/17/2026   D. McMahon      Add LOB prefetch to sql_define_lob
+** 10/17/2026   D. McMahon      Add sql_define_lobarr
+** 10/17/2026   D. McMahon      Free connection env copies on disconnect
 */
 
 #define WITH_OCI
@@ -90,6 +99,12 @@
 
 #define MAX_CSNAME    64                  /* Longest character set name    */
 
+#ifndef OLD_LOBS
+# ifndef LOB_PREFETCH   /* This is the default if OLD_LOBS isn't set   */
+#  define LOB_PREFETCH  /* This flag enables 11g LOB prefetch on fetch */
+# endif
+#endif
+
 /*
 ** Get size of array of connection objects
 */
@@ -121,6 +136,67 @@ sword sql_parse(connection *c, OraCursor stmhp, char *stmt, int slen)
     return(status);
 }
 
+/*
+** Release the statement obtained from the OCI statement cache, if any.
+** If drop_flag is set, the statement is removed from the cache rather
+** than returned to it (e.g. because it failed to execute).
+*/
+sword sql_release(connection *c, int drop_flag)
+{
+    sword status = OCI_SUCCESS;
+    ub4   mode;
+
+    if (c->stmhpc)
+    {
+        mode = (drop_flag) ? (ub4)OCI_STRLS_CACHE_DELETE : (ub4)OCI_DEFAULT;
+        status = OCIStmtRelease(c->stmhpc, c->errhp, (text *)0, (ub4)0, mode);
+        c->stmhpc = (OCIStmt *)0;
+    }
+    return(status);
+}
+
+/*
+** Prepare a user procedure call, using the OCI statement cache if
+** it's enabled for this connection.  The handle to use for binding
+** and execution is returned in *pstmhp; without the cache this is
+** simply the reusable stmhp3 handle.
+*/
+sword sql_prepare(connection *c, OraCursor *pstmhp, char *stmt, int slen)
+{
+    sword status;
+    ub4   stmtlen;
+
+    if (!(c->stmtcache))
+    {
+        *pstmhp = c->stmhp3;
+        return(sql_parse(c, c->stmhp3, stmt, slen));
+    }
+
+    if (!stmt) stmt = "";
+    stmtlen = (slen < 0) ? (ub4)str_length(stmt) : (ub4)slen;
+
+    sql_release(c, 0);
+
+    status = OCIStmtPrepare2(c->svchp, &(c->stmhpc), c->errhp,
+                             (text *)stmt, stmtlen, (text *)0, (ub4)0,
+                             (ub4)OCI_NTV_SYNTAX,
+                             (ub4)OCI_PREP2_CACHE_SEARCHONLY);
+    if (status == OCI_SUCCESS)
+        ++(c->stmt_hits);
+    else
+    {
+        ++(c->stmt_misses);
+        c->stmhpc = (OCIStmt *)0;
+        status = OCIStmtPrepare2(c->svchp, &(c->stmhpc), c->errhp,
+                                 (text *)stmt, stmtlen, (text *)0, (ub4)0,
+                                 (ub4)OCI_NTV_SYNTAX, (ub4)OCI_DEFAULT);
+        if (status != OCI_SUCCESS) c->stmhpc = (OCIStmt *)0;
+    }
+
+    *pstmhp = (c->stmhpc) ? c->stmhpc : c->stmhp3;
+    return(status);
+}
+
 /*
 ** Fetch next row or piece
 ** Always pass 1
@@ -361,6 +437,234 @@ static void sql_dump_env(char *phase)
     file_close(fp);
 }
 
+/*
+** Shared per-location OCI environment and session pool, used in
+** place of a private environment/server/session per pool slot when
+** OwaSessionPool is set.  Created on first use and protected by the
+** location's pool mutex.
+*/
+typedef struct sql_spool
+{
+    OCIEnv   *envhp;
+    OCIError *errhp;
+    OCISPool *spoolhp;
+    text     *poolname;
+    ub4       pnlen;
+} sql_spool;
+
+/*
+** Attach a connection to the shared environment, creating the
+** environment and the session pool if necessary.  The pool is
+** created heterogeneous, with the default credentials for the
+** location, so that sessions for other users can also be drawn
+** from it.
+*/
+static sword sql_spool_create(connection *c, owa_context *octx,
+                              char *username, int ulen,
+                              char *password, int plen,
+                              char *database, int dlen)
+{
+    sword      status = OCI_SUCCESS;
+    sql_spool *sp;
+    ub4        mode;
+    ub4        smin, smax, sincr;
+    ub1        getmode;
+
+    mowa_acquire_mutex(octx);
+
+    sp = (sql_spool *)octx->spool;
+    if (!sp)
+    {
+        sp = (sql_spool *)mem_alloc(sizeof(*sp));
+        if (!sp)
+        {
+            mowa_release_mutex(octx);
+            c->mem_err = sizeof(*sp);
+            return(OCI_ERROR);
+        }
+        mem_zero(sp, sizeof(*sp));
+        octx->spool = (void *)sp;
+    }
+
+    if (!(sp->envhp))
+    {
+        status = OCIEnvCreate(&(sp->envhp), (ub4)OCI_THREADED, (dvoid *)0,
+                              (dvoid * (*)(dvoid *, size_t))0,
+                              (dvoid * (*)(dvoid *, dvoid *, size_t))0,
+                              (dvoid (*)(dvoid *, dvoid *))0,
+                              (size_t)0, (dvoid **)0);
+        if (status != OCI_SUCCESS)
+        {
+            sp->envhp = (OCIEnv *)0;
+            mowa_release_mutex(octx);
+            return(status);
+        }
+        status = OCIHandleAlloc(sp->envhp, (dvoid **)&(sp->errhp),
+                                (ub4)OCI_HTYPE_ERROR, (size_t)0, (dvoid **)0);
+        if (status != OCI_SUCCESS) sp->errhp = (OCIError *)0;
+    }
+
+    c->envhp = sp->envhp;
+    c->spooled = 1;
+
+    status = OCIHandleAlloc(c->envhp, (dvoid **)&(c->errhp),
+                            (ub4)OCI_HTYPE_ERROR, (size_t)0, (dvoid **)0);
+    if (status != OCI_SUCCESS)
+    {
+        c->errhp = (OCIError *)0;
+        mowa_release_mutex(octx);
+        return(status);
+    }
+
+    if (!(sp->spoolhp))
+    {
+        status = OCIHandleAlloc(sp->envhp, (dvoid **)&(sp->spoolhp),
+                                (ub4)OCI_HTYPE_SPOOL, (size_t)0, (dvoid **)0);
+        if (status == OCI_SUCCESS)
+        {
+            smax = (ub4)octx->spool_max;
+            if (smax == 0) smax = (ub4)octx->poolsize;
+            smin = (ub4)octx->spool_min;
+            if (smax < smin) smax = smin;
+            if (smax == 0) smax = 1;
+            sincr = (ub4)((octx->spool_incr > 0) ? octx->spool_incr : 1);
+
+            mode = (ub4)OCI_DEFAULT;
+            if (c->stmtcache) mode |= (ub4)OCI_SPC_STMTCACHE;
+
+            status = OCISessionPoolCreate(sp->envhp, c->errhp, sp->spoolhp,
+                                          (text **)&(sp->poolname),
+                                          &(sp->pnlen),
+                                          (text *)database, (ub4)dlen,
+                                          smin, smax, sincr,
+                                          (text *)username, (ub4)ulen,
+                                          (text *)password, (ub4)plen,
+                                          mode);
+        }
+        if (status == OCI_SUCCESS)
+        {
+            /* Block, rather than fail, when the pool is at its maximum */
+            getmode = (ub1)OCI_SPOOL_ATTRVAL_WAIT;
+            status = OCIAttrSet(sp->spoolhp, (ub4)OCI_HTYPE_SPOOL,
+                                (dvoid *)&getmode, (ub4)0,
+                                (ub4)OCI_ATTR_SPOOL_GETMODE, c->errhp);
+        }
+        if ((status == OCI_SUCCESS) && (c->stmtcache))
+            status = OCIAttrSet(sp->spoolhp, (ub4)OCI_HTYPE_SPOOL,
+                                (dvoid *)&(c->stmtcache), (ub4)0,
+                                (ub4)OCI_ATTR_SPOOL_STMTCACHESIZE, c->errhp);
+        if (status != OCI_SUCCESS)
+        {
+            if (sp->spoolhp)
+                OCIHandleFree((dvoid *)(sp->spoolhp), (ub4)OCI_HTYPE_SPOOL);
+            sp->spoolhp = (OCISPool *)0;
+        }
+    }
+
+    mowa_release_mutex(octx);
+
+    return(status);
+}
+
+/*
+** Get a session for the specified user from the shared pool, and
+** pick up the session and server handles from the service context.
+*/
+static sword sql_spool_get(connection *c, owa_context *octx,
+                           char *username, int ulen,
+                           char *password, int plen)
+{
+    sword      status;
+    sql_spool *sp = (sql_spool *)octx->spool;
+    ub4        buflen;
+
+    if (!(c->authp))
+    {
+        status = OCIHandleAlloc(c->envhp, (dvoid **)&(c->authp),
+                                (ub4)OCI_HTYPE_AUTHINFO, (size_t)0,
+                                (dvoid **)0);
+        if (status != OCI_SUCCESS)
+        {
+            c->authp = (OCIAuthInfo *)0;
+            return(status);
+        }
+    }
+
+    status = OCIAttrSet(c->authp, (ub4)OCI_HTYPE_AUTHINFO, username,
+                        (ub4)ulen, (ub4)OCI_ATTR_USERNAME, c->errhp);
+    if (status != OCI_SUCCESS) return(status);
+    status = OCIAttrSet(c->authp, (ub4)OCI_HTYPE_AUTHINFO, password,
+                        (ub4)plen, (ub4)OCI_ATTR_PASSWORD, c->errhp);
+    if (status != OCI_SUCCESS) return(status);
+
+    status = OCISessionGet(c->envhp, c->errhp, &(c->svchp), c->authp,
+                           (text *)(sp->poolname), sp->pnlen,
+                           (text *)0, (ub4)0, (text **)0, (ub4 *)0,
+                           (boolean *)0, (ub4)OCI_SESSGET_SPOOL);
+    if ((status != OCI_SUCCESS) && (status != OCI_SUCCESS_WITH_INFO))
+    {
+        c->svchp = (OCISvcCtx *)0;
+        return(status);
+    }
+
+    if (OCIAttrGet(c->svchp, (ub4)OCI_HTYPE_SVCCTX, (dvoid *)&(c->seshp),
+                   &buflen, (ub4)OCI_ATTR_SESSION, c->errhp) != OCI_SUCCESS)
+        c->seshp = (OCISession *)0;
+    if (OCIAttrGet(c->svchp, (ub4)OCI_HTYPE_SVCCTX, (dvoid *)&(c->srvhp),
+                   &buflen, (ub4)OCI_ATTR_SERVER, c->errhp) != OCI_SUCCESS)
+        c->srvhp = (OCIServer *)0;
+
+    return(status);
+}
+
+/*
+** Return a session to the shared pool.  The service context, session,
+** and server handles belong to the pool and are not freed here.
+*/
+static sword sql_spool_put(connection *c, int drop_flag)
+{
+    sword status = OCI_SUCCESS;
+    ub4   mode;
+
+    if (c->svchp)
+    {
+        mode = (drop_flag) ? (ub4)OCI_SESSRLS_DROPSESS : (ub4)OCI_DEFAULT;
+        status = OCISessionRelease(c->svchp, c->errhp, (text *)0,
+                                   (ub4)0, mode);
+    }
+    c->svchp = (OCISvcCtx *)0;
+    c->seshp = (OCISession *)0;
+    c->srvhp = (OCIServer *)0;
+    return(status);
+}
+
+/*
+** Destroy the shared session pool and environment for a location.
+** All pool slots must already have been disconnected.
+*/
+void sql_spool_close(owa_context *octx)
+{
+    sql_spool *sp;
+
+    mowa_acquire_mutex(octx);
+    sp = (sql_spool *)octx->spool;
+    octx->spool = (void *)0;
+    mowa_release_mutex(octx);
+
+    if (!sp) return;
+
+    if (sp->spoolhp)
+    {
+        OCISessionPoolDestroy(sp->spoolhp, sp->errhp, (ub4)OCI_SPD_FORCE);
+        OCIHandleFree((dvoid *)(sp->spoolhp), (ub4)OCI_HTYPE_SPOOL);
+    }
+    if (sp->errhp)
+        OCIHandleFree((dvoid *)(sp->errhp), (ub4)OCI_HTYPE_ERROR);
+    if (sp->envhp)
+        OCIHandleFree((dvoid *)(sp->envhp), (ub4)OCI_HTYPE_ENV);
+    mem_free((void *)sp);
+}
+
 /*
 ** Create OCI connection
 */
@@ -424,6 +728,26 @@ sword sql_connect(connection *c, owa_context *octx,
 
             phase = "End prior OCI session";
 
+            /* Cached statements belong to the session being closed */
+            sql_release(c, 0);
+
+            /* Pooled sessions are swapped rather than re-authenticated */
+            if (c->spooled)
+            {
+                status = sql_spool_put(c, 0);
+                if (status != OCI_SUCCESS) goto connerr;
+                phase = "Get session from pool";
+                status = sql_spool_get(c, octx, username, ulen,
+                                       password, plen);
+                if (status == OCI_SUCCESS_WITH_INFO)
+                {
+                    if (errinfo) *errinfo = sql_get_error(c);
+                    status = OCI_SUCCESS;
+                }
+                if (status != OCI_SUCCESS) goto connerr;
+                goto setup_connection;
+            }
+
             /* Otherwise close old session and create new session for user */
             status = OCISessionEnd(c->svchp, c->errhp, c->seshp,
                                    (ub4)OCI_DEFAULT);
@@ -439,7 +763,9 @@ sword sql_connect(connection *c, owa_context *octx,
             phase = "Begin OCI session";
 
             status = OCISessionBegin(c->svchp, c->errhp, c->seshp,
-                                     (ub4)OCI_CRED_RDBMS, (ub4)OCI_DEFAULT);
+                                     (ub4)OCI_CRED_RDBMS,
+                                     (c->stmtcache) ? (ub4)OCI_STMT_CACHE :
+                                                      (ub4)OCI_DEFAULT);
             if (status == OCI_SUCCESS_WITH_INFO)
             {
                 if (errinfo) *errinfo = sql_get_error(c);
@@ -467,6 +793,10 @@ sword sql_connect(connection *c, owa_context *octx,
     c->stmhp3 = (OCIStmt *)0;
     c->stmhp4 = (OCIStmt *)0;
     c->stmhp5 = (OCIStmt *)0;
+    c->stmhpc = (OCIStmt *)0;
+    c->stmtcache = (ub4)((octx->stmt_cache > 0) ? octx->stmt_cache : 0);
+    c->authp = (OCIAuthInfo *)0;
+    c->spooled = 0;
     c->pblob = (OCILobLocator *)0;
     c->pclob = (OCILobLocator *)0;
     c->pnlob = (OCILobLocator *)0;
@@ -506,6 +836,20 @@ sword sql_connect(connection *c, owa_context *octx,
     password[plen] = '\0';
     dlen = (database) ? str_length(database) : 0;
 
+    /*
+    ** Session pool mode: create the shared pool with the default
+    ** credentials (if not already done).  Custom connect strings and
+    ** external authentication still get a private connection.
+    */
+    if ((octx->spool_incr > 0) && (!connstr) && (ulen > 0))
+    {
+        phase = "Create OCI session pool";
+        status = sql_spool_create(c, octx, username, ulen, password, plen,
+                                  database, dlen);
+        if (!(c->envhp)) goto handerr;
+        if (status != OCI_SUCCESS) goto connerr;
+    }
+
     if (octx->authrealm)
     {
         if ((authuser) && (authpass) && (!connstr))
@@ -518,6 +862,19 @@ sword sql_connect(connection *c, owa_context *octx,
         /* Else special call bypassing the authuser/authpass login */
     }
 
+    if (c->spooled)
+    {
+        phase = "Get session from pool";
+        status = sql_spool_get(c, octx, username, ulen, password, plen);
+        if (status == OCI_SUCCESS_WITH_INFO)
+        {
+            if (errinfo) *errinfo = sql_get_error(c);
+            status = OCI_SUCCESS;
+        }
+        if (status != OCI_SUCCESS) goto connerr;
+        goto create_handles;
+    }
+
     /*
     ** Initialize OCI handles
     */
@@ -574,7 +931,9 @@ sword sql_connect(connection *c, owa_context *octx,
       if (status != OCI_SUCCESS) goto connerr;
       phase = "Begin OCI session";
       status = OCISessionBegin(c->svchp, c->errhp, c->seshp,
-                               (ub4)OCI_CRED_RDBMS, (ub4)OCI_DEFAULT);
+                               (ub4)OCI_CRED_RDBMS,
+                               (c->stmtcache) ? (ub4)OCI_STMT_CACHE :
+                                                (ub4)OCI_DEFAULT);
     }
     /*
     ** Otherwise rely on external authentication (e.g. Oracle wallet)
@@ -583,7 +942,9 @@ sword sql_connect(connection *c, owa_context *octx,
     {
       phase = "Begin OCI session";
       status = OCISessionBegin(c->svchp, c->errhp, c->seshp,
-                               (ub4)OCI_CRED_EXT, (ub4)OCI_DEFAULT);
+                               (ub4)OCI_CRED_EXT,
+                               (c->stmtcache) ? (ub4)OCI_STMT_CACHE :
+                                                (ub4)OCI_DEFAULT);
       /* Remember external authentication failure */
       if ((status != OCI_SUCCESS) && (status != OCI_SUCCESS_WITH_INFO))
         extauth = 1;
@@ -600,6 +961,18 @@ sword sql_connect(connection *c, owa_context *octx,
                         (ub4)OCI_ATTR_SESSION, c->errhp);
     if (status != OCI_SUCCESS) goto connerr;
 
+create_handles:
+
+    /* Pooled sessions get their statement cache from the pool */
+    if ((c->stmtcache) && (!(c->spooled)))
+    {
+        phase = "Set statement cache size";
+        status = OCIAttrSet(c->svchp, (ub4)OCI_HTYPE_SVCCTX,
+                            (dvoid *)&(c->stmtcache), (ub4)0,
+                            (ub4)OCI_ATTR_STMTCACHESIZE, c->errhp);
+        if (status != OCI_SUCCESS) goto connerr;
+    }
+
     phase = "Create cursor handles";
     /*
     ** Create reusable cursor handles
@@ -950,6 +1323,27 @@ sword sql_disconnect(connection *c)
         c->session = (char *)0;
     }
 
+    /* Forget the CGI environment known to the old session */
+    if (c->env_copy)
+    {
+        mem_free((void *)(c->env_copy));
+        c->env_copy = (char *)0;
+    }
+    c->env_size = 0;
+    c->env_count = 0;
+    c->reset_due = 0;
+    c->docnames = (char *)0;
+
+    /* Return any cached statement before the session goes away */
+    if (c->stmhpc) sql_release(c, 0);
+
+    /*
+    ** Return a pooled session to the pool; if the connection is being
+    ** closed after an error (no error buffer), drop the session instead.
+    */
+    if (c->spooled)
+      status = sql_spool_put(c, (c->errbuf == (char *)0));
+
     /* End connection to server/service */
     if ((c->svchp) && (status == OCI_SUCCESS))
       status = OCISessionEnd(c->svchp, c->errhp, c->seshp, (ub4)OCI_DEFAULT);
@@ -991,6 +1385,10 @@ sword sql_disconnect(connection *c)
     if (c->pbfile)
         status = OCIDescriptorFree((dvoid *)(c->pbfile), (ub4)OCI_DTYPE_FILE);
     if (status != OCI_SUCCESS) goto closehand;
+    if (c->authp)
+      status = OCIHandleFree((dvoid *)(c->authp), (ub4)OCI_HTYPE_AUTHINFO);
+    c->authp = (OCIAuthInfo *)0;
+    if (status != OCI_SUCCESS) goto closehand;
     if (c->seshp)
       status = OCIHandleFree((dvoid *)(c->seshp), (ub4)OCI_HTYPE_SESSION);
     if (status != OCI_SUCCESS) goto closehand;
@@ -1003,7 +1401,8 @@ sword sql_disconnect(connection *c)
     if (c->errhp)
       status = OCIHandleFree((dvoid *)(c->errhp), (ub4)OCI_HTYPE_ERROR);
     if (status != OCI_SUCCESS) goto closehand;
-    if (c->envhp)
+    /* The shared environment is freed with the session pool */
+    if ((c->envhp) && (!(c->spooled)))
       status = OCIHandleFree((dvoid *)(c->envhp), (ub4)OCI_HTYPE_ENV);
 
 closehand:
@@ -1015,6 +1414,8 @@ closehand:
     }
     if (oerrno) status = oerrno;
 
+    c->spooled = 0;
+
     return(status);
 }
 
@@ -1298,22 +1699,23 @@ static sb4 sql_put_output(dvoid *ctx, OCIBind *bindp, ub4 iter, ub4 index,
 /*
 ** Bind array of string pointers
 */
-sword sql_bind_ptrs(connection *c, OraCursor stmhp, ub4 pos,
-                    char **aptr, sb4 awidth, ub4 *asize, ub4 amax)
+static sword bind_dynamic(connection *c, OraCursor stmhp, ub4 pos,
+                          char **aptr, sb4 awidth, ub4 *asize, ub4 amax,
+                          int raw_flag)
 {
     sword    status;
     sb2      sqltype;
     OCIBind *bhand;
 
     /* Bind strings as CHR to avoid need to pass the null terminator */
-    sqltype = (c->ncflag & UNI_MODE_RAW) ? SQLT_BIN : SQLT_CHR;
+    sqltype = (raw_flag) ? SQLT_BIN : SQLT_CHR;
 
     status = OCIBindByPos(stmhp, &bhand, c->errhp, pos,
                           (dvoid *)0, awidth, sqltype,
                           (dvoid *)0, (ub2 *)0, (ub2 *)0,
                           amax, asize, (ub4)OCI_DATA_AT_EXEC);
 
-    if (!(c->ncflag & UNI_MODE_RAW))
+    if (!raw_flag)
       if (status == OCI_SUCCESS)
         status = set_cs_info(c, bhand);
 
@@ -1331,6 +1733,24 @@ sword sql_bind_ptrs(connection *c, OraCursor stmhp, ub4 pos,
     return(status);
 }
 
+sword sql_bind_ptrs(connection *c, OraCursor stmhp, ub4 pos,
+                    char **aptr, sb4 awidth, ub4 *asize, ub4 amax)
+{
+    return(bind_dynamic(c, stmhp, pos, aptr, awidth, asize, amax,
+                        (c->ncflag & UNI_MODE_RAW)));
+}
+
+/*
+** Bind array of string pointers as character data, even in raw mode.
+** Only the actual length of each string is sent, so awidth can be
+** generous without costing anything on the wire.
+*/
+sword sql_bind_strs(connection *c, OraCursor stmhp, ub4 pos,
+                    char **aptr, sb4 awidth, ub4 *asize, ub4 amax)
+{
+    return(bind_dynamic(c, stmhp, pos, aptr, awidth, asize, amax, 0));
+}
+
 /*
 ** Bind a LOB locator to an OCI statement
 */
@@ -1398,9 +1818,32 @@ sword sql_bind_lob(connection *c, OraCursor stmhp, ub4 pos, ub2 flag)
 }
 
 /*
-** Define a LOB locator for a SELECT statement column
+** Have a LOB define return the length and up to prefetch bytes of
+** data with each locator
+*/
+static sword define_prefetch(connection *c, OCIDefine *dhand, ub4 prefetch)
+{
+    sword status = OCI_SUCCESS;
+#ifdef LOB_PREFETCH
+    boolean lenflag = (boolean)1;
+
+    status = OCIAttrSet(dhand, (ub4)OCI_HTYPE_DEFINE, &lenflag, (ub4)0,
+                        (ub4)OCI_ATTR_LOBPREFETCH_LENGTH, c->errhp);
+    if (status == OCI_SUCCESS)
+        status = OCIAttrSet(dhand, (ub4)OCI_HTYPE_DEFINE, &prefetch, (ub4)0,
+                            (ub4)OCI_ATTR_LOBPREFETCH_SIZE, c->errhp);
+#endif
+    return(status);
+}
+
+/*
+** Define a LOB locator for a SELECT statement column.  If prefetch
+** is non-zero, the LOB length and up to that many bytes of data are
+** returned along with the locator, so reading a small LOB needs no
+** further round trips.
 */
-sword sql_define_lob(connection *c, OraCursor stmhp, ub4 pos, ub2 flag)
+sword sql_define_lob(connection *c, OraCursor stmhp, ub4 pos, ub2 flag,
+                     ub4 prefetch)
 {
     sword           status;
     ub2             cs_id;
@@ -1460,6 +1903,29 @@ sword sql_define_lob(connection *c, OraCursor stmhp, ub4 pos, ub2 flag)
 #endif
     }
 
+    if ((status == OCI_SUCCESS) && (prefetch > 0))
+        status = define_prefetch(c, dhand, prefetch);
+
+    return(status);
+}
+
+/*
+** Define an array of BLOB locators for a multi-row fetch
+*/
+sword sql_define_lobarr(connection *c, OraCursor stmhp, ub4 pos,
+                        OCILobLocator **locs, sb2 *inds, ub4 prefetch)
+{
+    sword      status;
+    OCIDefine *dhand;
+
+    status = OCIDefineByPos(stmhp, &dhand, c->errhp, pos, (dvoid *)locs,
+                            (sb4)sizeof(*locs), (ub2)SQLT_BLOB,
+                            (dvoid *)inds, (ub2 *)0, (ub2 *)0,
+                            (ub4)OCI_DEFAULT);
+
+    if ((status == OCI_SUCCESS) && (prefetch > 0))
+        status = define_prefetch(c, dhand, prefetch);
+
     return(status);
 }
 
@@ -1834,51 +2300,69 @@ static int check_positional(connection *c, dvoid *arg_list,
 }
 
 /*
-** Describe PL/SQL procedure and attempt to adjust array parameters
-** Returns TRUE for successful conversion, FALSE otherwise.
+** Collect the names of the PL/SQL table arguments in an argument list,
+** skipping any already present.  Returns the new length of the list.
 */
-int sql_describe(connection *c, char *pname, int descmode, char *schema,
-                 int nargs, char *names[], ub4 counts[])
+static int check_tables(connection *c, dvoid *arg_list,
+                        char *names, int nlen, int maxlen)
 {
-    int          result;
-    sword        status;
-    int          tmpresult;
-    ub4          slen;
-    ub1          ptype;
-    ub4          cnt;
-    char        *sptr;
-    dvoid       *arg_list;
-    dvoid       *argp;
-    dvoid       *proc_list;
-    ub2          pcount;
-    OCIParam    *parmp;
-    OCIDescribe *dschp;
-    char        *namep;
-    ub4          namsz;
-    char         tempname[1000]; /* 2x identifier size is much smaller */
+    sword  status;
+    ub4    pos;
+    ub4    acount;
+    char  *namep;
+    ub4    namsz;
+    dvoid *argp;
+    ub2    dtype;
+    int    i;
 
-    result = 0;
-    if (descmode == DESC_MODE_STRICT) return(result);
+    status = OCIAttrGet(arg_list, (ub4)OCI_DTYPE_PARAM, (dvoid *)&acount,
+                        (ub4 *)0, (ub4)OCI_ATTR_NUM_PARAMS, c->errhp);
+    if (status != OCI_SUCCESS) return(nlen);
 
-    sptr = str_char(pname, '.', 1);
-    if (sptr)
-    {
-        ptype = OCI_PTYPE_PKG;
-        slen = (ub4)(sptr - pname);
-        ++sptr;
-    }
-    else
+    for (pos = 1; pos <= acount; ++pos)
     {
-        ptype = OCI_PTYPE_PROC;
-        slen = str_length(pname);
+        status = OCIParamGet(arg_list, (ub4)OCI_DTYPE_PARAM,
+                             c->errhp, (dvoid **)&argp, (ub4)pos);
+        if (status != OCI_SUCCESS) break;
+
+        status = OCIAttrGet(argp, (ub4)OCI_DTYPE_PARAM,
+                            (dvoid *)&dtype, (ub4 *)0,
+                            (ub4)OCI_ATTR_DATA_TYPE, c->errhp);
+        if (status != OCI_SUCCESS) break;
+        if (dtype != PLSQL_TAB) continue;
+
+        status = OCIAttrGet(argp, (ub4)OCI_DTYPE_PARAM,
+                            (dvoid *)&namep, (ub4 *)&namsz,
+                            (ub4)OCI_ATTR_NAME, c->errhp);
+        if (status != OCI_SUCCESS) break;
+        if (namsz == 0) continue;
+
+        for (i = 0; i < nlen; i += str_length(names + i) + 1)
+            if ((!str_compare(names + i, namep, namsz, 1)) &&
+                (names[i + namsz] == '\0'))
+                break;
+        if (i < nlen) continue;
+
+        if ((nlen + (int)namsz + 2) > maxlen) break;
+        mem_copy(names + nlen, namep, (size_t)namsz);
+        nlen += (int)namsz;
+        names[nlen++] = '\0';
     }
 
-    /*
-    ** Create the describe handle
-    */
-    status = OCIHandleAlloc(c->envhp, (dvoid **)&dschp,
-                            (ub4)OCI_HTYPE_DESCRIBE, 0, (dvoid **)0);
-    if (status != OCI_SUCCESS) return(result);
+    return(nlen);
+}
+
+/*
+** Describe a procedure or package by name, following synonyms
+*/
+static sword describe_object(connection *c, char *pname, ub4 slen,
+                             ub1 ptype, OCIDescribe *dschp)
+{
+    sword        status;
+    OCIParam    *parmp;
+    char        *namep;
+    ub4          namsz;
+    char         tempname[1000]; /* 2x identifier size is much smaller */
 
     status = OCIDescribeAny(c->svchp, c->errhp,
                             (dvoid *)pname, (ub4)slen, (ub1)OCI_OTYPE_NAME,
@@ -1888,30 +2372,30 @@ int sql_describe(connection *c, char *pname, int descmode, char *schema,
         /* Make sure to find any public synonym definitions */
         status = OCIAttrSet(dschp, (ub4)OCI_HTYPE_DESCRIBE, (dvoid *)0, (ub4)0,
                             (ub4)OCI_ATTR_DESC_PUBLIC, c->errhp);
-        if (status != OCI_SUCCESS) goto descexit;
+        if (status != OCI_SUCCESS) return(status);
 
         /* This could be because the pname in question is a synonym */
         status = OCIDescribeAny(c->svchp, c->errhp,
                                 (dvoid *)pname, (ub4)slen, (ub1)OCI_OTYPE_NAME,
                                 (ub1)OCI_DEFAULT, OCI_PTYPE_SYN, dschp);
-        if (status != OCI_SUCCESS) goto descexit;
+        if (status != OCI_SUCCESS) return(status);
 
         /* Synonym describe successful */
         status = OCIAttrGet(dschp, (ub4)OCI_HTYPE_DESCRIBE, (dvoid *)&parmp,
                             (ub4 *)0, (ub4)OCI_ATTR_PARAM, c->errhp);
-        if (status != OCI_SUCCESS) goto descexit;
+        if (status != OCI_SUCCESS) return(status);
 
         status = OCIAttrGet(parmp, (ub4)OCI_DTYPE_PARAM,
                             (dvoid *)&namep, &namsz,
                             (ub4)OCI_ATTR_SCHEMA_NAME, c->errhp);
-        if (status != OCI_SUCCESS) goto descexit;
+        if (status != OCI_SUCCESS) return(status);
         slen = namsz;
         mem_copy(tempname, namep, (size_t)namsz);
         tempname[slen++] = '.';
         status = OCIAttrGet(parmp, (ub4)OCI_DTYPE_PARAM,
                             (dvoid *)&namep, &namsz,
                             (ub4)OCI_ATTR_NAME, c->errhp);
-        if (status != OCI_SUCCESS) goto descexit;
+        if (status != OCI_SUCCESS) return(status);
         mem_copy(tempname + slen, namep, (size_t)namsz);
         slen += namsz;
         tempname[slen] = '\0';
@@ -1921,9 +2405,60 @@ int sql_describe(connection *c, char *pname, int descmode, char *schema,
                                 (dvoid *)tempname, (ub4)slen,
                                 (ub1)OCI_OTYPE_NAME,
                                 (ub1)OCI_DEFAULT, ptype, dschp);
-        if (status != OCI_SUCCESS) goto descexit;
     }
 
+    return(status);
+}
+
+/*
+** Describe PL/SQL procedure and attempt to adjust array parameters
+** Returns TRUE for successful conversion, FALSE otherwise.
+*/
+int sql_describe(connection *c, char *pname, int descmode, char *schema,
+                 int nargs, char *names[], ub4 counts[])
+{
+    int          result;
+    sword        status;
+    int          tmpresult;
+    ub4          slen;
+    ub1          ptype;
+    ub4          cnt;
+    char        *sptr;
+    dvoid       *arg_list;
+    dvoid       *argp;
+    dvoid       *proc_list;
+    ub2          pcount;
+    OCIParam    *parmp;
+    OCIDescribe *dschp;
+    char        *namep;
+    ub4          namsz;
+
+    result = 0;
+    if (descmode == DESC_MODE_STRICT) return(result);
+
+    sptr = str_char(pname, '.', 1);
+    if (sptr)
+    {
+        ptype = OCI_PTYPE_PKG;
+        slen = (ub4)(sptr - pname);
+        ++sptr;
+    }
+    else
+    {
+        ptype = OCI_PTYPE_PROC;
+        slen = str_length(pname);
+    }
+
+    /*
+    ** Create the describe handle
+    */
+    status = OCIHandleAlloc(c->envhp, (dvoid **)&dschp,
+                            (ub4)OCI_HTYPE_DESCRIBE, 0, (dvoid **)0);
+    if (status != OCI_SUCCESS) return(result);
+
+    status = describe_object(c, pname, slen, ptype, dschp);
+    if (status != OCI_SUCCESS) goto descexit;
+
     status = OCIAttrGet(dschp, (ub4)OCI_HTYPE_DESCRIBE, (dvoid *)&parmp,
                         (ub4 *)0, (ub4)OCI_ATTR_PARAM, c->errhp);
     if (status != OCI_SUCCESS) goto descexit;
@@ -2009,6 +2544,114 @@ descexit:
     return(result);
 }
 
+/*
+** Describe PL/SQL procedure and list its PL/SQL table arguments into
+** names, null-separated with a double-null terminator.  For packaged
+** procedures, the list covers every overloading.  Returns the number
+** of names found, or -1 if the procedure can't be described.
+*/
+int sql_describe_tables(connection *c, char *pname, char *names, int maxlen)
+{
+    int          result;
+    int          nlen;
+    sword        status;
+    ub4          slen;
+    ub1          ptype;
+    ub4          cnt;
+    char        *sptr;
+    dvoid       *arg_list;
+    dvoid       *argp;
+    dvoid       *proc_list;
+    ub2          pcount;
+    OCIParam    *parmp;
+    OCIDescribe *dschp;
+    char        *namep;
+    ub4          namsz;
+
+    result = -1;
+    nlen = 0;
+    if (maxlen < 2) return(result);
+
+    sptr = str_char(pname, '.', 1);
+    if (sptr)
+    {
+        ptype = OCI_PTYPE_PKG;
+        slen = (ub4)(sptr - pname);
+        ++sptr;
+    }
+    else
+    {
+        ptype = OCI_PTYPE_PROC;
+        slen = str_length(pname);
+    }
+
+    status = OCIHandleAlloc(c->envhp, (dvoid **)&dschp,
+                            (ub4)OCI_HTYPE_DESCRIBE, 0, (dvoid **)0);
+    if (status != OCI_SUCCESS) return(result);
+
+    status = describe_object(c, pname, slen, ptype, dschp);
+    if (status != OCI_SUCCESS) goto descexit;
+
+    status = OCIAttrGet(dschp, (ub4)OCI_HTYPE_DESCRIBE, (dvoid *)&parmp,
+                        (ub4 *)0, (ub4)OCI_ATTR_PARAM, c->errhp);
+    if (status != OCI_SUCCESS) goto descexit;
+
+    if (ptype == OCI_PTYPE_PROC)
+    {
+        status = OCIAttrGet(parmp, (ub4)OCI_DTYPE_PARAM, (dvoid *)&arg_list,
+                            (ub4 *)0, (ub4)OCI_ATTR_LIST_ARGUMENTS, c->errhp);
+        if (status != OCI_SUCCESS) goto descexit;
+
+        nlen = check_tables(c, arg_list, names, nlen, maxlen);
+        result = 0;
+    }
+    else /* ptype == OCI_PTYPE_PKG */
+    {
+        slen = str_length(sptr);
+        status = OCIAttrGet(parmp, (ub4)OCI_DTYPE_PARAM, (dvoid *)&proc_list,
+                            (ub4 *)0, (ub4)OCI_ATTR_LIST_SUBPROGRAMS,
+                            c->errhp);
+        if (status != OCI_SUCCESS) goto descexit;
+
+        status = OCIAttrGet(proc_list, (ub4)OCI_DTYPE_PARAM, (dvoid *)&pcount,
+                            (ub4 *)0, (ub4)OCI_ATTR_NUM_PARAMS, c->errhp);
+        if (status != OCI_SUCCESS) goto descexit;
+
+        for (cnt = 0; cnt < pcount; ++cnt)
+        {
+            status = OCIParamGet(proc_list, (ub4)OCI_DTYPE_PARAM,
+                                 c->errhp, (dvoid **)&argp, (ub4)cnt);
+            if (status != OCI_SUCCESS) break;
+
+            status = OCIAttrGet(argp, (ub4)OCI_DTYPE_PARAM,
+                                (dvoid *)&namep, &namsz,
+                                (ub4)OCI_ATTR_NAME, c->errhp);
+            if (status != OCI_SUCCESS) break;
+
+            if ((slen == namsz) && (!str_compare(namep, sptr, namsz, 1)))
+            {
+                status = OCIAttrGet(argp, (ub4)OCI_DTYPE_PARAM,
+                                    (dvoid *)&arg_list, (ub4 *)0,
+                                    (ub4)OCI_ATTR_LIST_ARGUMENTS, c->errhp);
+                if (status != OCI_SUCCESS) break;
+
+                nlen = check_tables(c, arg_list, names, nlen, maxlen);
+                result = 0;
+            }
+        }
+    }
+
+descexit:
+    status = OCIHandleFree((dvoid *)dschp, (ub4)OCI_HTYPE_DESCRIBE);
+
+    names[nlen] = '\0';
+    if (result == 0)
+        for (sptr = names; *sptr; sptr += str_length(sptr) + 1)
+            ++result;
+
+    return(result);
+}
+
 /*
 ** Return the OCI major/minor version numbers
 */
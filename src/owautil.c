@@ -52,6 +52,7 @@
 **   str_char         reversible search for character in string
 **   str_substr       case-controlled search for substring in string
 **   str_dup          duplicate string
+**   str_hash         case-controlled hash of a string
 **   str_chrcmp       case-aware comparison of two characters
 **   str_prepend      prepend a string to another string
 **   str_ltoa         convert 64-bit long integer to string
@@ -62,8 +63,16 @@
 **   str_btox         convert binary array to hex string
 **   str_xtob         convert hex string to binary array
 **   mem_find         find binary pattern in binary buffer
+**   mem_pattern_init precompute a pattern for repeated mem_scan calls
+**   mem_scan         find precomputed pattern in binary buffer
 **   mem_compare      compare two binary arrays
 **
+** Argument index functions
+**   argx_init        set up an index of argument names
+**   argx_find        find an argument by name in an index
+**   argx_add         add an argument to an index, growing it as needed
+**   argx_collect     convert repeated arguments to collections
+**
 ** Misc. functions
 **   util_get_method  get HTTP method name given numeric code
 **   util_print_time  print formatted date/time
@@ -109,6 +118,9 @@
 ** 06/21/2013   D. McMahon      Add util_csv_escape
 ** 09/19/2013   D. McMahon      Add str_ltoa
 ** 10/07/2020   D. McMahon      New mime types
+** 10/17/2026   D. McMahon      Add str_hash
+** 10/17/2026   D. McMahon      Horspool search for mem_find, add mem_scan
+** 10/17/2026   D. McMahon      Move the argument index here from owahand.c
 */
 
 #include <modowa.h>
@@ -227,6 +239,28 @@ char *str_dup(const char *sptr)
     return(newstr);
 }
 
+/*
+** Length-limited hash of a string with case-control flag (FNV-1a).
+** Strings that compare equal with str_compare() and the same flags
+** always hash to the same value.
+*/
+un_long str_hash(const char *sptr, int maxlen, int caseflag)
+{
+    un_long h = (un_long)2166136261UL;
+    int     ch;
+
+    if (!sptr) return(h);
+    if (maxlen < 0) maxlen = LONG_MAXSZ;
+
+    while ((maxlen-- > 0) && (*sptr != '\0'))
+    {
+        ch = ((int)*(sptr++) & 0xFF);
+        if ((caseflag) && (ch >= 'A') && (ch <= 'Z')) ch += ('a' - 'A');
+        h = ((h ^ (un_long)ch) * (un_long)16777619UL) & (un_long)0xFFFFFFFF;
+    }
+    return(h);
+}
+
 /*
 ** Case-aware comparison of two characters
 */
@@ -410,28 +444,95 @@ int str_xtob(char *s, void *p)
 }
 
 /*
-** Scan buffer for pattern or part of pattern
+** Precompute the shift table for a pattern.  The pattern string is
+** referenced, not copied, so it must outlive the mem_pattern.
 */
-char *mem_find(char *mptr, long_64 mlen, const char *mpat, int plen)
+void mem_pattern_init(mem_pattern *mp, const char *mpat, int plen)
 {
-    int i, n;
+    int i;
+
+    if ((!mpat) || (plen < 0)) plen = 0;
+    mp->pat = mpat;
+    mp->plen = plen;
+    for (i = 0; i < 256; ++i) mp->skip[i] = plen;
+    for (i = 0; i < plen - 1; ++i)
+        mp->skip[(unsigned char)mpat[i]] = plen - 1 - i;
+}
+
+/*
+** Scan buffer for pattern or part of pattern.
+**
+** Returns the first complete occurrence of the pattern.  Failing that,
+** returns the earliest position at which the tail of the buffer is a
+** prefix of the pattern, so that a caller streaming blocks can carry
+** those bytes over into the next block and rescan.  Returns null if
+** neither is found.
+**
+** Complete matches use a Boyer-Moore-Horspool scan keyed on the byte
+** under the end of the pattern; multipart boundaries are long and
+** mostly distinct, so this typically advances close to plen bytes
+** per comparison instead of one.
+*/
+char *mem_scan(mem_pattern *mp, char *mptr, long_64 mlen)
+{
+    int            i, n;
+    int            plen = mp->plen;
+    const char    *mpat = mp->pat;
+    unsigned char  c;
+    unsigned char  first;
+    unsigned char  last;
+    long_64        pos;
+
+    if ((plen <= 0) || (!mptr) || (mlen <= 0)) return((char *)0);
 
-    n = plen;
+    first = (unsigned char)mpat[0];
+    last = (unsigned char)mpat[plen - 1];
 
-    if ((plen > 0) && (mptr) && (mpat))
-        while (mlen > 0)
+    pos = 0;
+    while (pos <= mlen - (long_64)plen)
+    {
+        c = (unsigned char)mptr[pos + plen - 1];
+        if ((c == last) && ((unsigned char)mptr[pos] == first))
         {
-            if ((long_64)n > mlen) n = (int)mlen;
-            for (i = 0; i < n; ++i)
-                if (mptr[i] != mpat[i])
+            for (i = 1; i < plen - 1; ++i)
+                if (mptr[pos + i] != mpat[i])
                     break;
-            if (i == n) return(mptr);
-            ++mptr;
-            --mlen;
+            if (i >= plen - 1) return(mptr + pos);
         }
+        pos += (long_64)(mp->skip[c]);
+    }
+
+    /*
+    ** No complete match; look for a partial match at the tail.  The
+    ** Horspool shift is only safe for complete matches, so restart
+    ** from the first position that can't hold a complete pattern.
+    */
+    pos = mlen - (long_64)plen + 1;
+    if (pos < 0) pos = 0;
+    for (; pos < mlen; ++pos)
+    {
+        if ((unsigned char)mptr[pos] != first) continue;
+        n = (int)(mlen - pos);
+        for (i = 1; i < n; ++i)
+            if (mptr[pos + i] != mpat[i])
+                break;
+        if (i == n) return(mptr + pos);
+    }
     return((char *)0);
 }
 
+/*
+** Scan buffer for pattern or part of pattern (one-shot form of mem_scan)
+*/
+char *mem_find(char *mptr, long_64 mlen, const char *mpat, int plen)
+{
+    mem_pattern mp;
+
+    if ((plen <= 0) || (!mptr) || (!mpat)) return((char *)0);
+    mem_pattern_init(&mp, mpat, plen);
+    return(mem_scan(&mp, mptr, mlen));
+}
+
 /*
 ** Compare two binary arrays
 */
@@ -455,6 +556,175 @@ int mem_compare(char *ptr1, int len1, char *ptr2, int len2)
     return(0);
 }
 
+/*
+** Set up an index with room for at least n names
+*/
+int argx_init(arg_index *ax, int n)
+{
+    int sz;
+    int m;
+
+    for (sz = HTBUF_PARAM_CHUNK; sz < (n * 2); sz <<= 1);
+    m = sz * (int)(sizeof(un_long) + sizeof(int));
+    ax->hvals = (un_long *)(*(ax->afunc))(ax->actx, (size_t)m, 1);
+    if (!(ax->hvals)) return(-m);
+    ax->slots = (int *)(void *)(ax->hvals + sz);
+    ax->mask = sz - 1;
+    ax->count = 0;
+    return(0);
+}
+
+/*
+** Find the position of an argument by name, or return -1
+*/
+int argx_find(arg_index *ax, char **names, char *name, un_long h)
+{
+    int i, k;
+
+    if (!(ax->slots)) return(-1);
+    for (i = (int)(h & ax->mask); (k = ax->slots[i]) != 0;
+         i = (i + 1) & ax->mask)
+        if (ax->hvals[i] == h)
+            if (!str_compare(names[k - 1], name, -1, 1))
+                return(k - 1);
+    return(-1);
+}
+
+static void argx_put(arg_index *ax, int pos, un_long h)
+{
+    int i;
+
+    for (i = (int)(h & ax->mask); ax->slots[i]; i = (i + 1) & ax->mask);
+    ax->slots[i] = pos + 1;
+    ax->hvals[i] = h;
+    ++(ax->count);
+}
+
+/*
+** Add an argument position to the index, doubling the table when
+** it becomes half full
+*/
+int argx_add(arg_index *ax, int pos, un_long h)
+{
+    arg_index nx;
+    int       i, m;
+
+    if (!(ax->slots) || (((ax->count + 1) * 2) > (ax->mask + 1)))
+    {
+        nx.afunc = ax->afunc;
+        nx.actx = ax->actx;
+        m = argx_init(&nx, (ax->slots) ? (ax->mask + 1) : 0);
+        if (m < 0) return(m);
+        if (ax->slots)
+            for (i = 0; i <= ax->mask; ++i)
+                if (ax->slots[i])
+                    argx_put(&nx, ax->slots[i] - 1, ax->hvals[i]);
+        *ax = nx;
+    }
+    argx_put(ax, pos, h);
+    return(0);
+}
+
+/*
+** Convert multi-valued arguments to collection form, using an empty
+** index to find the repeated names
+*/
+int argx_collect(arg_index *ax, int *nargs, file_arg *filelist,
+                 char **param_name, char **param_value,
+                 char ***param_array, arg_count *param_count)
+{
+    int       i, j, n, m;
+    file_arg *afile;
+    un_long   h;
+    char    **aptr;
+
+    /* If there's 0 or 1 argument, nothing to do */
+    n = *nargs;
+    if (n <= 1) return(0);
+
+    m = argx_init(ax, n);
+    if (m < 0) return(m);
+
+    /* Go through all arguments, looking each up among the earlier ones */
+    for (i = 0; i < n; ++i)
+    {
+      if (!param_name[i]) continue;
+
+      h = str_hash(param_name[i], -1, 1);
+      j = argx_find(ax, param_name, param_name[i], h);
+      if (j < 0)
+      {
+        argx_put(ax, i, h); /* Sized for n names, so never grows */
+        continue;
+      }
+
+      /* If it matched, then it should be a collection binding */
+      {
+        /* If this is the first duplicate, convert the original to collection */
+        if (param_value[j] != (char *)0)
+        {
+          m = sizeof(char *) * HTBUF_PARAM_CHUNK;
+          param_array[j] = (char **)(*(ax->afunc))(ax->actx, (size_t)m, 0);
+          if (!param_array[j]) return(-m);
+          param_array[j][0] = param_value[j];
+          param_value[j] = (char *)0;
+        }
+        /* Otherwise, resize the collection if necessary */
+        if (ARR_FULL(param_count[j]))
+        {
+            m = (int)(param_count[j] + ARR_GROWTH(param_count[j]));
+            m *= sizeof(char *);
+            aptr = (char **)(*(ax->afunc))(ax->actx, (size_t)m, 1);
+            if (!aptr) return(-m);
+            mem_copy(aptr, param_array[j], param_count[j] * sizeof(char *));
+            param_array[j] = aptr;
+        }
+        /* Move the duplicate value into the collection */
+        param_array[j][param_count[j]++] = param_value[i];
+        /* Mark the duplicate as unused */
+        param_name[i] = (char *)0;
+        /*
+        ** ### If it's a file argument, blindly fix up the location.
+        ** ### This assumes all duplicate file arguments are sequential.
+        */
+        if (filelist)
+        {
+          int basepos = filelist->param_num;
+          for (afile = filelist; afile; afile = afile->next)
+          {
+            if (afile->param_num == i)
+            {
+              afile->param_num = basepos;
+              break;
+            }
+            basepos = afile->param_num;
+          }
+        }
+      }
+    }
+
+    /* Shift values to remove the "holes" */
+    for (i = j = 0; i < n; ++i)
+    {
+        if (param_name[i])
+        {
+          if (j < i)
+          {
+            param_name[j] = param_name[i];
+            param_value[j] = param_value[i];
+            param_array[j] = param_array[i];
+            param_count[j] = param_count[i];
+            for (afile = filelist; afile; afile = afile->next)
+              if (afile->param_num == i) afile->param_num = j;
+          }
+          ++j;
+        }
+    }
+    *nargs = j;
+
+    return(0);
+}
+
 static char *method_list[] = {"GET","PUT","POST","DELETE","CONNECT","OPTIONS",
                               "TRACE","PATCH","PROPFIND","PROPPATCH","MKCOL",
                               "COPY","MOVE","LOCK","UNLOCK","VERSION_CONTROL",
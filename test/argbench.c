@@ -0,0 +1,350 @@
+/*
+** mod_owa
+**
+** Copyright (c) 1999-2019 Oracle Corporation, All rights reserved.
+**
+** The Universal Permissive License (UPL), Version 1.0
+**
+** Subject to the condition set forth below, permission is hereby granted
+** to any person obtaining a copy of this software, associated documentation
+** and/or data (collectively the "Software"), free of charge and under any
+** and all copyright rights in the Software, and any and all patent rights
+** owned or freely licensable by each licensor hereunder covering either
+** (i) the unmodified Software as contributed to or provided by such licensor,
+** or (ii) the Larger Works (as defined below), to deal in both
+** 
+** (a) the Software, and
+** (b) any piece of software and/or hardware listed in the lrgrwrks.txt file
+** if one is included with the Software (each a "Larger Work" to which the
+** Software is contributed by such licensors),
+** 
+** without restriction, including without limitation the rights to copy, create
+** derivative works of, display, perform, and distribute the Software and make,
+** use, sell, offer for sale, import, export, have made, and have sold the
+** Software and the Larger Work(s), and to sublicense the foregoing rights on
+** either these or other terms.
+** 
+** This license is subject to the following condition:
+** The above copyright notice and either this complete permission notice or at
+** a minimum a reference to the UPL must be included in all copies or
+** substantial portions of the Software.
+** 
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+** IN THE SOFTWARE.
+*/
+/*
+** Save this file as argbench.c
+**
+** Add these lines to your existing mod_owa Makefile:
+**
+** argbench: argbench.o $(OBJS)
+**	$(LD) -o $@ argbench.o $(OBJS) $(ORALINK) $(CLIBS)
+**
+** make -kf modowa.mk argbench
+**
+** argbench [<nparams> ...]
+**
+** Times the collation of repeated argument names done by argx_collect
+** in owautil.c, for form posts shaped like an Apex tabular form (rows
+** of f01..f50), and for posts where every name is distinct, which is
+** the worst case for pairwise comparison.  The default runs 10000 and
+** 50000 parameters.  The original pairwise collation is copied below
+** as collate_pairwise, and both are run over the same parsed body and
+** their results checked against each other.  The collated names are
+** then added one at a time to an index with argx_add, the way the
+** query string parser does, and each is looked up with argx_find.
+** A bump allocator stands in for the request pool.
+*/
+
+#include <stdio.h>
+#include <modowa.h>
+
+#define BENCH_COLUMNS  50  /* Columns in a tabular form post */
+
+/*
+** Bump allocator standing in for the request pool
+*/
+static char   *pool_base = (char *)0;
+static size_t  pool_size = 0;
+static size_t  pool_used = 0;
+
+static void *pool_alloc(void *actx, size_t sz, int zero_flag)
+{
+    void *ptr;
+
+    sz = (sz + 7) & ~((size_t)7);
+    if ((pool_used + sz) > pool_size) return((void *)0);
+    ptr = (void *)(pool_base + pool_used);
+    pool_used += sz;
+    if (zero_flag) mem_zero(ptr, sz);
+    return(ptr);
+}
+
+static void bench_index(arg_index *ax)
+{
+    mem_zero(ax, sizeof(*ax));
+    ax->afunc = pool_alloc;
+}
+
+/*
+** Parsed argument arrays, as built by the query string parser
+*/
+typedef struct bench_args
+{
+    int         nargs;
+    char      **names;
+    char      **values;
+    char     ***arrays;
+    arg_count  *counts;
+} bench_args;
+
+/*
+** Build a body of nparams arguments in rows of ncols names, and
+** parse it into args
+*/
+static int bench_parse(bench_args *args, int nparams, int ncols)
+{
+    char  *body;
+    char  *sptr;
+    int    i;
+
+    body = (char *)pool_alloc((void *)0, (size_t)nparams * 32 + 1, 0);
+    if (!body) return(0);
+    for (sptr = body, i = 0; i < nparams; ++i)
+        sptr += sprintf(sptr, "%sf%02d=r%dc%d", (i > 0) ? "&" : "",
+                        (i % ncols) + 1, i / ncols, i % ncols);
+
+    args->names = (char **)pool_alloc((void *)0, sizeof(char *) * nparams, 0);
+    args->values = (char **)pool_alloc((void *)0, sizeof(char *) * nparams, 0);
+    args->arrays = (char ***)pool_alloc((void *)0,
+                                        sizeof(char **) * nparams, 1);
+    args->counts = (arg_count *)pool_alloc((void *)0,
+                                           sizeof(arg_count) * nparams, 1);
+    if (!(args->counts)) return(0);
+
+    for (sptr = body, i = 0; (i < nparams) && (*sptr); ++i)
+    {
+        args->names[i] = sptr;
+        while (*sptr != '=') ++sptr;
+        *(sptr++) = '\0';
+        args->values[i] = sptr;
+        while ((*sptr) && (*sptr != '&')) ++sptr;
+        if (*sptr) *(sptr++) = '\0';
+        args->counts[i] = 1;
+    }
+    args->nargs = i;
+    return(1);
+}
+
+/*
+** The original collation: compare each name with every earlier one,
+** and grow collections HTBUF_PARAM_CHUNK entries at a time
+*/
+static int collate_pairwise(bench_args *args)
+{
+    char **aptr;
+    int    i, j, n;
+
+    for (i = 1; i < args->nargs; ++i)
+    {
+        for (j = 0; j < i; ++j)
+            if (args->names[i])
+                if (!str_compare(args->names[i], args->names[j], -1, 1))
+                    break;
+        if (j == i) continue;
+
+        if (args->values[j])
+        {
+            aptr = (char **)pool_alloc((void *)0,
+                                       sizeof(char *) * HTBUF_PARAM_CHUNK, 0);
+            if (!aptr) return(0);
+            aptr[0] = args->values[j];
+            args->arrays[j] = aptr;
+            args->values[j] = (char *)0;
+        }
+        n = (int)args->counts[j];
+        if ((n % HTBUF_PARAM_CHUNK) == 0)
+        {
+            aptr = (char **)pool_alloc((void *)0, sizeof(char *) *
+                                       (n + HTBUF_PARAM_CHUNK), 1);
+            if (!aptr) return(0);
+            mem_copy(aptr, args->arrays[j], n * sizeof(char *));
+            args->arrays[j] = aptr;
+        }
+        args->arrays[j][args->counts[j]++] = args->values[i];
+        args->names[i] = (char *)0;
+    }
+
+    for (i = j = 0; i < args->nargs; ++i)
+        if (args->names[i])
+        {
+            if (j < i)
+            {
+                args->names[j] = args->names[i];
+                args->values[j] = args->values[i];
+                args->arrays[j] = args->arrays[i];
+                args->counts[j] = args->counts[i];
+            }
+            ++j;
+        }
+    args->nargs = j;
+    return(1);
+}
+
+/*
+** Compare the collated results of the two methods
+*/
+static int bench_check(bench_args *a, bench_args *b)
+{
+    int        i;
+    arg_count  n;
+
+    if (a->nargs != b->nargs) return(0);
+    for (i = 0; i < a->nargs; ++i)
+    {
+        if (str_compare(a->names[i], b->names[i], -1, 0)) return(0);
+        if (a->counts[i] != b->counts[i]) return(0);
+        if ((!(a->values[i])) != (!(b->values[i]))) return(0);
+        if (a->values[i])
+        {
+            if (str_compare(a->values[i], b->values[i], -1, 0)) return(0);
+            continue;
+        }
+        for (n = 0; n < a->counts[i]; ++n)
+            if (str_compare(a->arrays[i][n], b->arrays[i][n], -1, 0))
+                return(0);
+    }
+    return(1);
+}
+
+/*
+** Add the collated names to a growing index, then find each one
+*/
+static int bench_lookup(bench_args *args)
+{
+    arg_index ax;
+    int       i;
+
+    bench_index(&ax);
+    for (i = 0; i < args->nargs; ++i)
+    {
+        if (argx_find(&ax, args->names, args->names[i],
+                      str_hash(args->names[i], -1, 1)) >= 0)
+            return(0);
+        if (argx_add(&ax, i, str_hash(args->names[i], -1, 1)) < 0)
+            return(0);
+    }
+    for (i = 0; i < args->nargs; ++i)
+        if (argx_find(&ax, args->names, args->names[i],
+                      str_hash(args->names[i], -1, 1)) != i)
+            return(0);
+    return(1);
+}
+
+/*
+** Return elapsed microseconds since sec/musec
+*/
+static long bench_elapsed(un_long sec, un_long musec)
+{
+    un_long esec;
+    un_long emusec;
+
+    esec = os_get_time(&emusec);
+    return((long)(esec - sec) * 1000000L + (long)emusec - (long)musec);
+}
+
+static int bench_run(int nparams, int ncols)
+{
+    bench_args  old_args;
+    bench_args  new_args;
+    arg_index   ax;
+    un_long     sec;
+    un_long     musec;
+    long        old_time;
+    long        new_time;
+
+    pool_used = 0;
+    if (!bench_parse(&old_args, nparams, ncols)) return(0);
+    if (!bench_parse(&new_args, nparams, ncols)) return(0);
+
+    sec = os_get_time(&musec);
+    if (!collate_pairwise(&old_args)) return(0);
+    old_time = bench_elapsed(sec, musec);
+
+    bench_index(&ax);
+    sec = os_get_time(&musec);
+    if (argx_collect(&ax, &new_args.nargs, (file_arg *)0,
+                     new_args.names, new_args.values,
+                     new_args.arrays, new_args.counts) < 0)
+        return(0);
+    new_time = bench_elapsed(sec, musec);
+
+    printf("%8d params, %6d names: pairwise %10ld us, hashed %8ld us  %s\n",
+           nparams, new_args.nargs, old_time, new_time,
+           (bench_check(&old_args, &new_args) && bench_lookup(&new_args))
+           ? "ok" : "MISMATCH");
+    return(1);
+}
+
+int main(argc, argv)
+int   argc;
+char *argv[];
+{
+    int  sizes[2];
+    int *psizes;
+    int  nsizes;
+    int  nparams;
+    int  i;
+
+    /* Sizes come from the command line, or else the defaults */
+    if (argc > 1)
+    {
+        nsizes = argc - 1;
+        psizes = (int *)mem_alloc(sizeof(int) * nsizes);
+        if (!psizes) return(1);
+        for (i = 0; i < nsizes; ++i)
+        {
+            psizes[i] = atoi(argv[i + 1]);
+            if (psizes[i] <= 0)
+            {
+                printf("Usage: %s [<nparams> ...]\n", argv[0]);
+                return(0);
+            }
+        }
+    }
+    else
+    {
+        sizes[0] = 10000;
+        sizes[1] = 50000;
+        psizes = sizes;
+        nsizes = 2;
+    }
+
+    /* Enough for two parsed copies of the largest body, plus collections */
+    for (nparams = 0, i = 0; i < nsizes; ++i)
+        if (psizes[i] > nparams) nparams = psizes[i];
+    pool_size = (size_t)nparams * 512 + (size_t)(1 << 20);
+    pool_base = (char *)mem_alloc(pool_size);
+    if (!pool_base)
+    {
+        printf("%s can't allocate %d bytes\n", argv[0], (int)pool_size);
+        return(1);
+    }
+
+    for (i = 0; i < nsizes; ++i)
+        if ((!bench_run(psizes[i], BENCH_COLUMNS)) ||
+            (!bench_run(psizes[i], psizes[i])))
+        {
+            printf("%s ran out of memory\n", argv[0]);
+            break;
+        }
+
+    mem_free((void *)pool_base);
+    if (psizes != sizes) mem_free((void *)psizes);
+    return(0);
+}
@@ -0,0 +1,306 @@
+/*
+** mod_owa
+**
+** Copyright (c) 1999-2019 Oracle Corporation, All rights reserved.
+**
+** The Universal Permissive License (UPL), Version 1.0
+**
+** Subject to the condition set forth below, permission is hereby granted
+** to any person obtaining a copy of this software, associated documentation
+** and/or data (collectively the "Software"), free of charge and under any
+** and all copyright rights in the Software, and any and all patent rights
+** owned or freely licensable by each licensor hereunder covering either
+** (i) the unmodified Software as contributed to or provided by such licensor,
+** or (ii) the Larger Works (as defined below), to deal in both
+** 
+** (a) the Software, and
+** (b) any piece of software and/or hardware listed in the lrgrwrks.txt file
+** if one is included with the Software (each a "Larger Work" to which the
+** Software is contributed by such licensors),
+** 
+** without restriction, including without limitation the rights to copy, create
+** derivative works of, display, perform, and distribute the Software and make,
+** use, sell, offer for sale, import, export, have made, and have sold the
+** Software and the Larger Work(s), and to sublicense the foregoing rights on
+** either these or other terms.
+** 
+** This license is subject to the following condition:
+** The above copyright notice and either this complete permission notice or at
+** a minimum a reference to the UPL must be included in all copies or
+** substantial portions of the Software.
+** 
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+** IN THE SOFTWARE.
+*/
+/*
+** Save this file as scanbench.c
+**
+** Add these lines to your existing mod_owa Makefile:
+**
+** scanbench: scanbench.o $(OBJS)
+**	$(LD) -o $@ scanbench.o $(OBJS) $(ORALINK) $(CLIBS)
+**
+** make -kf modowa.mk scanbench
+**
+** scanbench [<megabytes>]
+**
+** Checks mem_find and mem_scan in owautil.c against the original
+** byte-by-byte mem_find (copied below as naive_find), then times both
+** on a buffer of random binary data ending in a multipart boundary,
+** the shape of a large file upload.  The default buffer is 64 MB.
+**
+** The correctness pass covers the contract that multipart parsing
+** relies on: the first complete match wins, and failing that, the
+** earliest position at which the tail of the buffer is a prefix of the
+** pattern is returned, so a streaming caller can carry those bytes
+** into the next block.  Random buffers over a small alphabet make
+** partial tails and near-misses common.  A streamed pass then feeds
+** the same data in blocks through one mem_pattern, with carry-over,
+** and checks that the boundaries are found at the same offsets.
+*/
+
+#include <stdio.h>
+#include <modowa.h>
+
+#define CHECK_ROUNDS   200000
+#define STREAM_BLOCK   4096
+
+/*
+** The original scan: compare the pattern at every position, shortening
+** it at the tail of the buffer to find partial matches
+*/
+static char *naive_find(char *mptr, long_64 mlen, const char *mpat, int plen)
+{
+    int i, n;
+
+    n = plen;
+
+    if ((plen > 0) && (mptr) && (mpat))
+        while (mlen > 0)
+        {
+            if ((long_64)n > mlen) n = (int)mlen;
+            for (i = 0; i < n; ++i)
+                if (mptr[i] != mpat[i])
+                    break;
+            if (i == n) return(mptr);
+            ++mptr;
+            --mlen;
+        }
+    return((char *)0);
+}
+
+/*
+** Small linear congruential generator, so runs are repeatable
+*/
+static un_long rand_state = 12345;
+
+static int rand_next(int range)
+{
+    rand_state = (rand_state * 1103515245 + 12345) & 0x7FFFFFFF;
+    return((int)((rand_state >> 8) % (un_long)range));
+}
+
+static void rand_fill(char *buf, int len, const char *alphabet, int alen)
+{
+    int i;
+
+    for (i = 0; i < len; ++i)
+        buf[i] = (alen > 0) ? alphabet[rand_next(alen)]
+                            : (char)rand_next(256);
+}
+
+/*
+** Compare mem_find with naive_find on random short buffers
+*/
+static int check_random(void)
+{
+    char        buf[64];
+    char        pat[16];
+    char       *p1;
+    char       *p2;
+    int         blen;
+    int         plen;
+    int         round;
+    const char *alphabet = "ab-\r\n";
+
+    for (round = 0; round < CHECK_ROUNDS; ++round)
+    {
+        blen = rand_next((int)sizeof(buf));
+        plen = rand_next((int)sizeof(pat) - 1) + 1;
+        rand_fill(buf, blen, alphabet, 1 + rand_next(5));
+        rand_fill(pat, plen, alphabet, 1 + rand_next(5));
+
+        p1 = naive_find(buf, (long_64)blen, pat, plen);
+        p2 = mem_find(buf, (long_64)blen, pat, plen);
+        if (p1 != p2)
+        {
+            printf("Mismatch on round %d: buffer %d, pattern %d bytes,"
+                   " naive %d, new %d\n", round, blen, plen,
+                   (p1) ? (int)(p1 - buf) : -1,
+                   (p2) ? (int)(p2 - buf) : -1);
+            return(0);
+        }
+    }
+    printf("%d random buffers: ok\n", CHECK_ROUNDS);
+    return(1);
+}
+
+/*
+** Find every boundary in a buffer by streaming it through mem_scan in
+** blocks, carrying partial matches over the block edges the way the
+** multipart parser does, and compare with naive_find over the whole
+** buffer
+*/
+static int check_stream(char *buf, long_64 blen, char *pat, int plen)
+{
+    mem_pattern  mp;
+    char         block[STREAM_BLOCK];
+    char        *sptr;
+    char        *nptr;
+    long_64      base;     /* Buffer offset of the start of block */
+    long_64      fed;      /* Bytes of buffer copied into blocks so far */
+    long_64      noff;
+    int          n;
+    int          keep;
+    int          found = 0;
+
+    mem_pattern_init(&mp, pat, plen);
+    nptr = naive_find(buf, blen, pat, plen);
+
+    base = 0;
+    fed = 0;
+    n = 0;
+    while ((fed < blen) || (n > 0))
+    {
+        /* Top up the block from the buffer */
+        keep = (int)sizeof(block) - n;
+        if ((long_64)keep > (blen - fed)) keep = (int)(blen - fed);
+        mem_copy(block + n, buf + fed, keep);
+        fed += (long_64)keep;
+        n += keep;
+
+        sptr = mem_scan(&mp, block, (long_64)n);
+        if ((sptr) && ((int)(sptr - block) + plen <= n))
+        {
+            /* A complete boundary; it should be the next naive match */
+            noff = base + (long_64)(sptr - block);
+            if ((!nptr) || ((long_64)(nptr - buf) != noff))
+            {
+                printf("Stream mismatch at offset %d\n", (int)noff);
+                return(0);
+            }
+            ++found;
+            nptr = naive_find(nptr + plen, blen - (noff + plen), pat, plen);
+            if ((nptr) && ((nptr - buf) + plen > blen)) nptr = (char *)0;
+            keep = (int)(sptr - block) + plen;
+        }
+        else if (sptr)
+        {
+            /* A partial boundary at the tail; carry it over */
+            keep = (int)(sptr - block);
+            if ((keep == 0) && (fed >= blen)) keep = n;
+        }
+        else
+            keep = n;
+
+        /* Discard everything before keep */
+        mem_copy(block, block + keep, n - keep);
+        n -= keep;
+        base += (long_64)keep;
+        if ((fed >= blen) && (keep == 0)) break;
+    }
+
+    if (nptr)
+    {
+        printf("Stream missed a boundary at offset %d\n", (int)(nptr - buf));
+        return(0);
+    }
+    printf("Streamed %d byte buffer in %d byte blocks: %d boundaries, ok\n",
+           (int)blen, STREAM_BLOCK, found);
+    return(1);
+}
+
+/*
+** Return elapsed microseconds since sec/musec
+*/
+static long bench_elapsed(un_long sec, un_long musec)
+{
+    un_long esec;
+    un_long emusec;
+
+    esec = os_get_time(&emusec);
+    return((long)(esec - sec) * 1000000L + (long)emusec - (long)musec);
+}
+
+int main(argc, argv)
+int   argc;
+char *argv[];
+{
+    char        *buf;
+    char        *pat;
+    char        *p1;
+    char        *p2;
+    long_64      blen;
+    long_64      pos;
+    int          plen;
+    int          mb;
+    un_long      sec;
+    un_long      musec;
+    long         old_time;
+    long         new_time;
+    mem_pattern  mp;
+
+    mb = (argc > 1) ? str_atoi(argv[1]) : 64;
+    if (mb <= 0)
+    {
+        printf("Usage: %s [<megabytes>]\n", argv[0]);
+        return(0);
+    }
+
+    if (!check_random()) return(1);
+
+    /* A boundary as the multipart parser sees it */
+    pat = "\r\n------WebKitFormBoundary7MA4YWxkTrZu0gW";
+    plen = str_length(pat);
+
+    /* Scatter a few boundaries through a short buffer and stream it */
+    blen = (long_64)(STREAM_BLOCK * 16);
+    buf = (char *)mem_alloc((size_t)blen);
+    if (!buf) return(1);
+    rand_fill(buf, (int)blen, "", 0);
+    for (pos = 1000; pos + plen < blen; pos += (long_64)(STREAM_BLOCK - 7))
+        mem_copy(buf + pos, pat, plen);
+    if (!check_stream(buf, blen, pat, plen)) return(1);
+    mem_free((void *)buf);
+
+    /* Time the search for the closing boundary of a large upload */
+    blen = (long_64)mb << 20;
+    buf = (char *)mem_alloc((size_t)blen);
+    if (!buf)
+    {
+        printf("%s can't allocate %d MB\n", argv[0], mb);
+        return(1);
+    }
+    rand_fill(buf, (int)(blen - plen), "", 0);
+    mem_copy(buf + blen - plen, pat, plen);
+
+    sec = os_get_time(&musec);
+    p1 = naive_find(buf, blen, pat, plen);
+    old_time = bench_elapsed(sec, musec);
+
+    mem_pattern_init(&mp, pat, plen);
+    sec = os_get_time(&musec);
+    p2 = mem_scan(&mp, buf, blen);
+    new_time = bench_elapsed(sec, musec);
+
+    printf("%d MB, %d byte boundary: naive %ld us, mem_scan %ld us  %s\n",
+           mb, plen, old_time, new_time, (p1 == p2) ? "ok" : "MISMATCH");
+
+    mem_free((void *)buf);
+    return((p1 == p2) ? 0 : 1);
+}